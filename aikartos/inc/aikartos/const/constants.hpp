@@ -10,9 +10,24 @@
 #include <cstdint>
 #include "aikartos/device/device.hpp"
 
+#if !defined(KERNEL_IRQ_CEILING)
+#	define KERNEL_IRQ_CEILING 5
+#endif
+
 namespace aikartos::constants {
 	constexpr std::uint32_t system_clock_frequency = PLATFORM_DEFAULT_SYSTEM_CLOCK_FREQUENCY;
 	constexpr std::uint32_t uart_clock_frequency = PLATFORM_DEFAULT_SYSTEM_CLOCK_FREQUENCY;
 	constexpr std::uint32_t default_baud_rate = 115'200u;
+	constexpr std::uint32_t tick_period_us = 1'000u; // SysTick period, one kernel tick
+
+	constexpr std::uint32_t systick_irq_priority = 8;
+	constexpr std::uint32_t pendsv_irq_priority = 15;
+
+	// Kernel critical sections mask the interrupts with this priority number and above (BASEPRI).
+	// The ones below it are never delayed by the kernel, and they must not call into it
+	constexpr std::uint32_t kernel_irq_ceiling = KERNEL_IRQ_CEILING;
+	constexpr std::uint32_t kernel_basepri = kernel_irq_ceiling << (8u - __NVIC_PRIO_BITS);
+	static_assert(kernel_irq_ceiling > 0, "BASEPRI = 0 masks nothing");
+	static_assert(kernel_irq_ceiling <= systick_irq_priority, "SysTick has to be under the kernel ceiling");
 	constexpr std::uint32_t quanta_infinite = 0xFFFF'FFFF; // No forced preemption (cooperative task)
 }
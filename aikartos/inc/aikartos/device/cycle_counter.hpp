@@ -0,0 +1,56 @@
+/*
+ * cycle_counter.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "aikartos/const/constants.hpp"
+#include "aikartos/device/device.hpp"
+
+namespace aikartos::device {
+	// DWT->CYCCNT, core clock cycles, wraps every 2^32 cycles
+	class cycle_counter {
+	public:
+		static void enable() {
+			CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#if defined(PLATFORM_h753_CORE)
+			// Cortex-M7: DWT is locked after reset
+			DWT->LAR = 0xC5ACCE55;
+#endif
+			DWT->CYCCNT = 0;
+			DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+		}
+
+		static bool is_enabled() {
+			return DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk;
+		}
+
+		inline static std::uint32_t now() {
+			return DWT->CYCCNT;
+		}
+
+		// Busy-waits. The counter has to be enabled (kernel launch does it).
+		// Up to 2^31 cycles: the other half of the range is the margin for a check that comes late
+		// (an interrupt in between), past it the difference wraps and the wait goes on for another 2^32
+		static void delay_cycles(std::uint32_t cycles) {
+			const std::uint32_t start = now();
+			while((now() - start) < cycles) {
+			}
+		}
+
+		static void delay_us(std::uint32_t microseconds) {
+			constexpr std::uint32_t cycles_per_us = constants::system_clock_frequency / 1'000'000;
+			// a chunk has to fit delay_cycles
+			constexpr std::uint32_t maximum_chunk = 0x7FFF'FFFF / cycles_per_us;
+			while(microseconds > maximum_chunk) {
+				delay_cycles(maximum_chunk * cycles_per_us);
+				microseconds -= maximum_chunk;
+			}
+			delay_cycles(microseconds * cycles_per_us);
+		}
+	};
+}
@@ -9,6 +9,8 @@
 
 #include "aikartos/device/device.hpp"
 #include "aikartos/kernel/panic.hpp"
+#include "aikartos/kernel/task_events.hpp"
+#include "aikartos/sync/kernel_critical_section.hpp"
 #include "aikartos/tasks/control_block.hpp"
 
 namespace aikartos::kernel {
@@ -16,9 +18,31 @@ namespace aikartos::kernel {
 	public:
 		using task_block = tasks::control_block;
 		static void yield() {
+			if(!is_in_interrupt()) {
+				yield_requested_ = true;
+				if(auto *handler = task_events::on_yield) {
+					sync::kernel_critical_section lock;
+					auto *task = get_current_tcb();
+					// sleep and exit have reported their own event already
+					if(task && (task->task.state != tasks::descriptor::state_type::WAIT)
+						&& (task->task.state != tasks::descriptor::state_type::DONE)) {
+						handler(task);
+					}
+				}
+			}
 			SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
 		}
 
+		// Directed yield: the scheduler is asked to switch to 'task' right away (sch::HasHandoff).
+		// If it can't, this is a plain yield. donate = true lets 'task' finish the caller's quanta
+		// instead of starting a fresh one
+		static void yield_to(task_block *task, bool donate = false) {
+			DEBUG_ASSERT(!is_in_interrupt(), "yield_to in an interrupt");
+			handoff_target_ = task;
+			handoff_donate_ = donate;
+			yield();
+		}
+
 		static void sleep(std::uint32_t millieconds) {
 			auto *current_tcb = get_current_tcb();
 			DEBUG_ASSERT(current_tcb != nullptr, "Bad current task...");
@@ -26,15 +50,66 @@ namespace aikartos::kernel {
 		}
 
 		static void sleep_task_for(task_block *task, std::uint32_t millieconds) {
-			task->task.timing.next_run = get_tick_count() + millieconds;
-			task->task.state = tasks::descriptor::state_type::WAIT;
+			block_task(task, get_tick_count() + millieconds);
 			yield();
 		}
 
+		// Absolute wakeup tick. Returns right away if it has already passed
+		static void sleep_until(std::uint32_t tick) {
+			auto *current_tcb = get_current_tcb();
+			DEBUG_ASSERT(current_tcb != nullptr, "Bad current task...");
+			sleep_task_until(current_tcb, tick);
+		}
+
+		static void sleep_task_until(task_block *task, std::uint32_t tick) {
+			if(static_cast<std::int32_t>(tick - get_tick_count()) <= 0) {
+				return;
+			}
+			block_task(task, tick);
+			yield();
+		}
+
+		// WAIT until 'tick' or an earlier sleep_queue::wake. The caller yields afterwards
+		static void block_task(task_block *task, std::uint32_t tick) {
+			sync::kernel_critical_section lock;
+			task->task.timing.next_run = tick;
+			task->task.state = tasks::descriptor::state_type::WAIT;
+			if(auto *handler = task_events::on_block) {
+				handler(task);
+			}
+		}
+
+		// Periodic tasks (tasks::config_flags::period): sleeps until the next release.
+		// Releases are next_run += period, so the task's own run time doesn't shift them.
+		// A late release runs right away and counts as an overrun, whole missed periods are skipped.
+		static void wait_next_period() {
+			auto *task = get_current_tcb();
+			DEBUG_ASSERT(task != nullptr, "Bad current task...");
+			auto &timing = task->task.timing;
+			DEBUG_ASSERT(timing.period_ms != 0, "Not a periodic task");
+
+			timing.next_run += timing.period_ms;
+			const auto late = static_cast<std::int32_t>(get_tick_count() - timing.next_run);
+			if(late > 0) {
+				const auto missed = static_cast<std::uint32_t>(late) / timing.period_ms;
+				timing.next_run += missed * timing.period_ms;
+				timing.overruns += missed + 1;
+				return;
+			}
+			sleep_task_until(task, timing.next_run);
+		}
+
 		static void terminate_current(bool need_yield = true) {
 			auto *task = get_current_tcb();
 			DEBUG_ASSERT(current_tcb != nullptr, "Bad current task...");
-			task->task.state = tasks::descriptor::state_type::DONE;
+			{
+				sync::kernel_critical_section lock;
+				const bool reported = (task->task.state == tasks::descriptor::state_type::DONE);
+				task->task.state = tasks::descriptor::state_type::DONE;
+				if(auto *handler = task_events::on_exit; handler && !reported) {
+					handler(task);
+				}
+			}
 			if(need_yield && !is_in_interrupt()) {
 				yield();
 			}
@@ -63,7 +138,29 @@ namespace aikartos::kernel {
 		}
 
 		static task_block *get_current_tcb();
-	private:
 		static std::uint32_t get_tick_count();
+
+		// true if the pending switch was requested by the running task itself. Resets the request
+		static bool consume_yield_request() {
+			const bool value = yield_requested_;
+			yield_requested_ = false;
+			return value;
+		}
+
+		struct handoff_request {
+			task_block *target = nullptr;
+			bool donate = false;
+		};
+
+		// The pending yield_to, if any. Resets it
+		static handoff_request consume_handoff() {
+			const handoff_request value { handoff_target_, handoff_donate_ };
+			handoff_target_ = nullptr;
+			return value;
+		}
+	private:
+		inline static volatile bool yield_requested_ = false;
+		inline static task_block *volatile handoff_target_ = nullptr;
+		inline static volatile bool handoff_donate_ = false;
 	};
 }
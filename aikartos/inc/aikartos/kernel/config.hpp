@@ -13,7 +13,9 @@ namespace aikartos::kernel {
 	struct config {
 		constexpr static std::uint32_t quanta = 10; // 10 milliseconds
 		constexpr static std::uint32_t stack_size = 600; // 600 words
-		constexpr static std::uint32_t maximum_tasks = 5;
+		constexpr static std::uint32_t maximum_tasks = 5; // utils::dynamic_extent: the task table and the queues grow from the heap
+		constexpr static bool tickless_idle = false; // stop SysTick while idle until the next sleeper is due
+		constexpr static std::uint32_t priority_levels = 32; // sch::bitmap_priority, up to 256
 		inline static auto idle_hook = []{};
 	};
 }
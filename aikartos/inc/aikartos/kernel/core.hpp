@@ -16,6 +16,9 @@
 #include "aikartos/kernel/api.hpp"
 #include "aikartos/kernel/config.hpp"
 #include "aikartos/kernel/impl.hpp"
+#include "aikartos/kernel/profiling.hpp"
+#include "aikartos/kernel/scheduler_lock.hpp"
+#include "aikartos/kernel/sleep_queue.hpp"
 #include "aikartos/sch/events.hpp"
 #include "aikartos/tasks/object.hpp"
 #include "aikartos/utils/object_pool.hpp"
@@ -52,18 +55,49 @@ namespace aikartos::kernel {
 			static impl<SchedulerT, ConfigT> instance;
 			DEBUG_ASSERT(instance_ == nullptr, "kernel already initialized");
 			instance_ = &instance;
+			dispatch_tag_ = &impl<SchedulerT, ConfigT>::dispatch_tag;
+		}
+
+		// true if init was called with the arguments of ImplT = impl<SchedulerT, ConfigT>
+		template <typename ImplT>
+		static bool is_initialized_as() {
+			return dispatch_tag_ == &ImplT::dispatch_tag;
 		}
 
 		static void launch(std::uint32_t quanta) {
 
 			// SysTick higher priority
-			device::timebase::systick_init(1'000, 8);
+			device::timebase::systick_init(constants::tick_period_us, constants::systick_irq_priority);
+			systick_cycles_per_tick_ = SysTick->LOAD + 1;
 
 			//PendSV lower priority
-			NVIC_SetPriority(PendSV_IRQn, 15);
+			NVIC_SetPriority(PendSV_IRQn, constants::pendsv_irq_priority);
+
+			// Time base of the per-task accounting
+			device::cycle_counter::enable();
 
 			impl_base::quanta_ = quanta;
 			impl_base::default_quanta_ = quanta;
+#if defined(KERNEL_USE_STACK_GUARD)
+			// The guard region is reprogrammed on every switch, the rest of the memory map stays default.
+			// It's the last one, the highest priority: 8 regions on the F411, 16 on the H753
+			const std::uint32_t mpu_regions = (MPU->TYPE & MPU_TYPE_DREGION_Msk) >> MPU_TYPE_DREGION_Pos;
+			ASSERT(mpu_regions > 0, "KERNEL_USE_STACK_GUARD needs an MPU");
+			stack_guard_region_ = mpu_regions - 1;
+			SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+			MPU->CTRL = MPU_CTRL_PRIVDEFENA_Msk | MPU_CTRL_ENABLE_Msk;
+			__DSB();
+			__ISB();
+#endif
+#if defined(PLATFORM_USE_FPU)
+			if(impl_base::get_fpu_auto_enable()) {
+				// NOCP has to reach UsageFault_Handler instead of escalating to HardFault
+				SCB->SHCSR |= SCB_SHCSR_USGFAULTENA_Msk;
+			}
+#endif
+#if defined(KERNEL_USE_PROFILING)
+			profiler::start();
+#endif
 			init_first_task();
 			kernel_launch_impl();
 		}
@@ -76,6 +110,21 @@ namespace aikartos::kernel {
 			return tick_count_;
 		}
 
+		// Monotonic time since launch: 64-bit ticks plus the elapsed part of the current tick (SysTick->VAL).
+		// Unlike DWT->CYCCNT it keeps counting while the core sleeps in WFI.
+		// Thread mode and interrupts under the kernel ceiling (constants::kernel_irq_ceiling) only: one above it
+		// may run in the middle of SysTick_Handler and see the time step back by a tick, or a half-updated 64-bit count
+		inline static std::uint64_t get_timestamp_cycles() {
+			const auto now = get_tick_fraction();
+			return now.ticks * systick_cycles_per_tick_ + now.cycles;
+		}
+
+		inline static std::uint64_t get_timestamp_us() {
+			constexpr std::uint32_t cycles_per_us = constants::system_clock_frequency / 1'000'000;
+			const auto now = get_tick_fraction();
+			return now.ticks * constants::tick_period_us + now.cycles / cycles_per_us;
+		}
+
 		inline static std::uint32_t get_quanta() {
 			return impl_base::quanta_;
 		}
@@ -109,11 +158,88 @@ namespace aikartos::kernel {
 			return instance_->get_scheduler_statistic(stat);
 		}
 
-		inline static void add_task(task_entry task, task_parameter parameter = nullptr) {
-			core::add_task(task, tasks::config{}, parameter);
+		// Per-task accounting (tasks::accounting_fields), one element per task, the idle task last
+		inline static bool get_tasks_statistic(sch::statistic_base &stat) {
+			return instance_->get_tasks_statistic(stat);
+		}
+
+		// The handle is for api::yield_to and friends, it's valid until the task is done
+		inline static task_block *add_task(task_entry task, task_parameter parameter = nullptr) {
+			return core::add_task(task, tasks::config{}, parameter);
+		}
+
+		static task_block *add_task(task_entry task, const tasks::config &config, task_parameter parameter = nullptr);
+
+		// Scheduling decision for PendSV, including the scheduler event handler round trip.
+		// ImplT = impl_base goes through the virtual call on instance_,
+		// ImplT = impl<SchedulerT, ConfigT> calls the scheduler directly (see kernel/static_dispatch.hpp)
+		template <typename ImplT = impl_base>
+		static task_block *select_next_task() {
+#if defined(KERNEL_USE_PROFILING)
+			// PendSV stamps its entry and exit on the deferred path too, its duration is collected all the same
+			const auto decision_begin = profiler::on_decision_begin();
+#endif
+			if(scheduler_lock::is_locked()) {
+				// the running task stays, scheduler_lock::unlock pends PendSV again
+				scheduler_lock::defer();
+#if defined(KERNEL_USE_PROFILING)
+				profiler::on_decision_end(decision_begin);
+#endif
+				return api::get_current_tcb();
+			}
+			// Consumed here: a yield that ends up with the same task must not leak into the next switch
+			voluntary_switch_ = api::consume_yield_request();
+
+			if(const auto request = api::consume_handoff(); request.target != nullptr) {
+				bool accepted = false;
+				if constexpr (std::is_same_v<ImplT, impl_base>) {
+					accepted = instance_->handoff(api::get_current_tcb(), request.target);
+				}
+				else {
+					accepted = ImplT::handoff_task(api::get_current_tcb(), request.target);
+				}
+				if(accepted) {
+					restart_quanta_ = !request.donate;
+#if defined(KERNEL_USE_PROFILING)
+					profiler::on_decision_end(decision_begin);
+#endif
+					return request.target;
+				}
+			}
+			while (1) {
+				sch::scheduler_specific_event event = sch::events::OK;
+				task_block *next = nullptr;
+				if constexpr (std::is_same_v<ImplT, impl_base>) {
+					next = instance_->get_next_task(event);
+				}
+				else {
+					next = ImplT::next_task(event);
+				}
+				if (event != sch::events::OK && instance_->scheduler_event_handler_) {
+					auto decision = instance_->scheduler_event_handler_(event);
+					if (decision == sch::decision::RETRY) {
+						continue;
+					}
+				}
+#if defined(KERNEL_USE_PROFILING)
+				profiler::on_decision_end(decision_begin);
+#endif
+				return next;
+			}
+		}
+
+#if defined(KERNEL_USE_PROFILING)
+		// Snapshot of the context switch histograms
+		static switch_profile get_switch_profile() {
+			sync::kernel_critical_section dirq;
+			return profiler::get();
 		}
 
-		static void add_task(task_entry task, const tasks::config &config, task_parameter parameter = nullptr);
+		static void reset_switch_profile() {
+			sync::kernel_critical_section dirq;
+			profiler::reset();
+		}
+#endif
 
 		constexpr static bool has_fpu() {
 #if defined(PLATFORM_USE_FPU) & PLATFORM_FPU_AVAILABLE
@@ -146,16 +272,47 @@ namespace aikartos::kernel {
 		static inline bool get_task_fpu_default() {
 			return impl_base::get_task_fpu_default();
 		}
+		static inline void set_fpu_auto_enable(bool value) {
+			impl_base::set_fpu_auto_enable(value);
+		}
+		static inline bool get_fpu_auto_enable() {
+			return impl_base::get_fpu_auto_enable();
+		}
 #endif
 
 	private:
 
+		struct tick_fraction {
+			std::uint64_t ticks;
+			std::uint32_t cycles;
+		};
+
+		static tick_fraction get_tick_fraction() {
+			sync::kernel_critical_section dirq;
+			std::uint64_t ticks = (static_cast<std::uint64_t>(tick_count_high_) << 32) | tick_count_;
+			std::uint32_t value = SysTick->VAL;
+			if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+				// the counter has reloaded, but SysTick_Handler hasn't counted the tick yet
+				ticks += 1;
+				value = SysTick->VAL;
+			}
+			return { ticks, (systick_cycles_per_tick_ - 1) - value };
+		}
+
 		static void init_first_task();
 
 		friend struct handlers_friend;
 
 		inline static volatile std::uint32_t tick_count_ = 0;
+		inline static volatile std::uint32_t tick_count_high_ = 0;
+		inline static std::uint32_t systick_cycles_per_tick_ = 0;
+		inline static bool voluntary_switch_ = false;
+		inline static volatile bool restart_quanta_ = false;
 		inline static impl_base *instance_ = nullptr;
+		inline static const char *dispatch_tag_ = nullptr;
+#if defined(KERNEL_USE_STACK_GUARD)
+		inline static std::uint32_t stack_guard_region_ = 0;
+#endif
 	};
 
 }
@@ -0,0 +1,96 @@
+/*
+ * deferred_work.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "aikartos/kernel/api.hpp"
+#include "aikartos/kernel/core.hpp"
+#include "aikartos/kernel/panic.hpp"
+#include "aikartos/kernel/sleep_queue.hpp"
+#include "aikartos/sync/kernel_critical_section.hpp"
+#include "aikartos/sync/mpsc_queue.hpp"
+
+#if !defined(KERNEL_DEFERRED_WORK_SIZE)
+#	define KERNEL_DEFERRED_WORK_SIZE 32
+#endif
+
+namespace aikartos::kernel {
+
+	// Bottom halves: interrupts post function + argument pairs, the worker task runs them.
+	// post() is lock-free and safe in any interrupt under the kernel ceiling (constants::kernel_irq_ceiling).
+	// The worker is an ordinary task, its priority comes from the config passed to launch()
+	class deferred_work {
+	public:
+		using function_type = void(*)(void *);
+
+		struct work_item {
+			function_type function = nullptr;
+			void *argument = nullptr;
+		};
+
+		constexpr static std::size_t capacity = KERNEL_DEFERRED_WORK_SIZE;
+		// the worker yields after that many items, so a flood can't starve its equals
+		constexpr static std::size_t batch_size = 8;
+
+		static void launch(const tasks::config &config = tasks::config{}) {
+			DEBUG_ASSERT(!launched_, "deferred work is already launched");
+			launched_ = true;
+			core::add_task(&deferred_work::task_entry, config);
+		}
+
+		// false if the queue is full, the item is counted in get_dropped()
+		static bool post(function_type function, void *argument = nullptr) {
+			if(!queue_.try_push({ function, argument })) {
+				dropped_.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			if(auto *task = task_) {
+				sleep_queue::wake(task);
+			}
+			return true;
+		}
+
+		static std::uint32_t get_dropped() {
+			return dropped_.load(std::memory_order_relaxed);
+		}
+
+	private:
+
+		static void task_entry(void *) {
+			task_ = api::get_current_tcb();
+			while(true) {
+				std::size_t done = 0;
+				while(auto item = queue_.try_pop()) {
+					item->function(item->argument);
+					if(++done == batch_size) {
+						done = 0;
+						api::yield();
+					}
+				}
+				{
+					sync::kernel_critical_section lock;
+					// an item that came after the last pop: its wake() found the worker running
+					if(!queue_.empty()) {
+						continue;
+					}
+					api::block_task(task_, core::get_tick_count() + idle_wait_ticks);
+				}
+				api::yield();
+			}
+		}
+
+		constexpr static std::uint32_t idle_wait_ticks = 0x7FFF'FFFF;
+
+		inline static sync::mpsc_queue<work_item, capacity> queue_;
+		inline static tasks::control_block *volatile task_ = nullptr;
+		inline static std::atomic<std::uint32_t> dropped_ = 0;
+		inline static bool launched_ = false;
+	};
+}
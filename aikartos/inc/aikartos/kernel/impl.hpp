@@ -11,7 +11,10 @@
 #include "aikartos/kernel/impl_base.hpp"
 
 #include "aikartos/kernel/panic.hpp"
-#include "aikartos/sync/irq_critical_section.hpp"
+#include "aikartos/kernel/scheduler_lock.hpp"
+#include "aikartos/kernel/sleep_queue.hpp"
+#include "aikartos/kernel/task_events.hpp"
+#include "aikartos/sync/kernel_critical_section.hpp"
 
 #include "aikartos/utils/container_of.hpp"
 #include "aikartos/utils/object_pool.hpp"
@@ -39,20 +42,64 @@ namespace aikartos::kernel {
 			static void on_task_done(tasks::control_block *object) {
 				scheduler_.clear_task(object);
 
-				sync::irq_critical_section dirq;
-				pool_.free(utils::container_of<task_object>(object, &task_object::tcb));
+				sync::kernel_critical_section dirq;
+				auto *pool_object = utils::container_of<task_object>(object, &task_object::tcb);
+				// O(1) for a growable pool too: a pool task's stack is the one inside its object,
+				// a heap task's follows its heap_object
+				if(object->stack_base == reinterpret_cast<std::uintptr_t>(&pool_object->stack[0])) {
+					pool_.free(pool_object);
+				}
+				else {
+					// Called from PendSV: the switch stores the outgoing context into this block yet.
+					// Heap tasks are returned to the allocator later, from thread mode (free_released_tasks)
+					object->scheduler_data = released_;
+					released_ = object;
+				}
 			}
 			static void on_quanta_change(std::uint32_t quanta) {
 				kernel::impl_base::quanta_ = quanta;
 			};
 		};
 
+		// kernel::task_events handlers for an event-driven scheduler
+		struct task_event_handlers {
+			static void on_block(tasks::control_block *task) {
+				scheduler_.on_block(task);
+				sleep_queue::push(task);
+			}
+			static void on_exit(tasks::control_block *task) {
+				if(task == &idle_.tcb) {
+					// not the scheduler's, it never goes away
+					return;
+				}
+				scheduler_.on_exit(task);
+				// only the running task exits, and it's gone before the next one can
+				DEBUG_ASSERT(exiting_ == nullptr, "Two tasks are exiting at once");
+				exiting_ = task;
+			}
+			static void on_yield(tasks::control_block *task) {
+				scheduler_.on_yield(task);
+			}
+		};
+
 	public:
 
 		~impl() noexcept = default;
 
 		impl() {
 			task_object_staсk_init(idle_.tcb, reinterpret_cast<std::uint32_t>(&impl::task_idle));
+			impl_base::wakeup_check_ = &impl::wakeup_check;
+			static_assert(sch::HasOnBlock<scheduler_type> == sch::HasOnWake<scheduler_type>,
+				"on_block and on_wake go together");
+			if constexpr (sch::HasOnBlock<scheduler_type>) {
+				task_events::on_block = &task_event_handlers::on_block;
+			}
+			if constexpr (sch::HasOnExit<scheduler_type>) {
+				task_events::on_exit = &task_event_handlers::on_exit;
+			}
+			if constexpr (sch::HasOnYield<scheduler_type>) {
+				task_events::on_yield = &task_event_handlers::on_yield;
+			}
 		}
 
 		using scheduler_type = SchedulerT<config_type, scheduler_callbacks>;
@@ -63,29 +110,99 @@ namespace aikartos::kernel {
 
 		control_block *add_task(task_entry task, task_parameter parameter, const tasks::config &config) override {
 
-			sync::irq_critical_section dirq;
+			free_released_tasks();
+
+			std::uint32_t stack_words = 0;
+			config.update_value<tasks::config_flags::stack_size>(stack_words);
+
+			tasks::heap_object *heap_task = nullptr;
+			control_block *tcb = nullptr;
+			if(stack_words > 0) {
+				// the allocator takes its own lock, no need to keep IRQs disabled for the whole allocation
+				heap_task = tasks::heap_object::create(stack_words);
+				ASSERT(heap_task, "Not enough memory for the task stack");
+				tcb = &heap_task->tcb;
+			}
+
+			{
+				// A new pool chunk and the scheduler's queues may be allocated here, with IRQs enabled:
+				// PendSV, the only other user of the pools and the queues, waits for the unlock
+				scheduler_lock_guard lock;
+				if(tcb == nullptr) {
+					tcb = &pool_.alloc()->tcb;
+				}
+				scheduler_.configure_task(tcb, config);
+			}
+
+			sync::kernel_critical_section dirq;
+
+			if(heap_task != nullptr) {
+				heap_tasks_.push_back(heap_task);
+			}
+			task_object_staсk_init(*tcb, reinterpret_cast<std::uint32_t>(task_wrapper));
+
+			tcb->task.state = tasks::descriptor::state_type::READY;
+			tcb->task.task = task;
+			tcb->task.parameter = parameter;
+
+			// the first release is now
+			tcb->task.timing = {};
+			config.update_value<tasks::config_flags::period>(tcb->task.timing.period_ms);
+			tcb->task.timing.next_run = kernel::api::get_tick_count();
 
-			auto object = pool_.alloc();
-			task_object_staсk_init(object->tcb, reinterpret_cast<std::uint32_t>(task_wrapper));
+			scheduler_.add_task(tcb);
+
+			return tcb;
+		}
 
-			object->tcb.task.state = tasks::descriptor::state_type::READY;
-			object->tcb.task.task = task;
-			object->tcb.task.parameter = parameter;
+		control_block *get_next_task(sch::scheduler_specific_event &event) override {
+			return next_task(event);
+		}
 
-			scheduler_.configure_task(&object->tcb, config);
-			scheduler_.add_task(&object->tcb);
+		bool handoff(control_block *current, control_block *target) override {
+			return handoff_task(current, target);
+		}
 
-			return &object->tcb;
+		// One per instantiation: core::init records its address, AIKARTOS_KERNEL_STATIC_DISPATCH compares it
+		inline static constexpr char dispatch_tag = 0;
+
+		// Non-virtual version of handoff
+		inline static bool handoff_task(control_block *current, control_block *target) {
+			if constexpr (sch::HasHandoff<scheduler_type>) {
+				// the scheduler has to see the same ready set as for a regular decision
+				settle_events();
+				if constexpr (!sch::HasOnWake<scheduler_type>) {
+					// it picks up the woken tasks in get_next_task only, one of them may outrank 'target'
+					if(sleep_queue::has_woken()) {
+						return false;
+					}
+				}
+				const auto runnable = [](const control_block *task) {
+					return (task->task.state == tasks::descriptor::state_type::READY)
+						|| (task->task.state == tasks::descriptor::state_type::RUNNING);
+				};
+				if((target == current) || (target == &idle_.tcb) || !runnable(target) || !runnable(current)) {
+					return false;
+				}
+				return scheduler_.handoff(current, target);
+			}
+			else {
+				return false;
+			}
 		}
 
-		std::tuple<control_block *, sch::scheduler_specific_event> get_next_task() override {
+		// Non-virtual version of get_next_task, used by the statically dispatched PendSV (kernel/static_dispatch.hpp)
+		inline static control_block *next_task(sch::scheduler_specific_event &event) {
+			settle_events();
 			if constexpr (std::is_same_v<decltype(scheduler_.get_next_task()), control_block *>) {
 				auto next_tcb = scheduler_.get_next_task();
-				return { next_tcb ? next_tcb : &idle_.tcb, sch::events::OK };
+				event = sch::events::OK;
+				return next_tcb ? next_tcb : &idle_.tcb;
 			}
 			else {
-				auto [next_tcb, event] = scheduler_.get_next_task();
-				return { next_tcb ? next_tcb : &idle_.tcb, event };
+				auto [next_tcb, next_event] = scheduler_.get_next_task();
+				event = next_event;
+				return next_tcb ? next_tcb : &idle_.tcb;
 			}
 		}
 
@@ -97,15 +214,125 @@ namespace aikartos::kernel {
 			}
 		};
 
+		bool get_tasks_statistic(sch::statistic_base &stat) override {
+			// the stack scan is long, keep the interrupts enabled
+			scheduler_lock_guard lock;
+			std::size_t current_task_id = 0;
+
+			const auto add = [&stat, &current_task_id](const control_block *tcb) {
+				const auto &acc = tcb->accounting;
+				const auto set = [&](tasks::accounting_fields field, std::uintptr_t value) {
+					stat.add_field(current_task_id, static_cast<std::size_t>(field), value);
+				};
+				set(tasks::accounting_fields::task_entry, reinterpret_cast<std::uintptr_t>(tcb->task.task));
+				set(tasks::accounting_fields::task_param, reinterpret_cast<std::uintptr_t>(tcb->task.parameter));
+				set(tasks::accounting_fields::state, static_cast<std::uintptr_t>(tcb->task.state));
+				set(tasks::accounting_fields::cycles_low, static_cast<std::uintptr_t>(acc.cycles & 0xFFFF'FFFF));
+				set(tasks::accounting_fields::cycles_high, static_cast<std::uintptr_t>(acc.cycles >> 32));
+				set(tasks::accounting_fields::dispatches, acc.dispatches);
+				set(tasks::accounting_fields::yields, acc.yields);
+				set(tasks::accounting_fields::preemptions, acc.preemptions);
+				set(tasks::accounting_fields::last_run, acc.last_run);
+				set(tasks::accounting_fields::stack_unused, tcb->stack_unused_words());
+				set(tasks::accounting_fields::overruns, tcb->task.timing.overruns);
+				current_task_id++;
+			};
+
+			pool_.foreach([&](task_object *object) {
+				if(current_task_id < stat.size()) {
+					add(&object->tcb);
+				}
+			});
+			// the list only changes in thread mode (add_task, free_released_tasks), the lock keeps it still
+			heap_tasks_.foreach([&](tasks::heap_object *object) {
+				if(current_task_id < stat.size()) {
+					add(&object->tcb);
+				}
+			});
+			// The idle task goes last, its task_entry is nullptr
+			if(current_task_id < stat.size()) {
+				add(&idle_.tcb);
+			}
+			return true;
+		}
+
 	private:
 
+		// Event-driven schedulers, before any decision: the exited task goes away, the woken ones are handed over
+		inline static void settle_events() {
+			if constexpr (sch::HasOnExit<scheduler_type>) {
+				// the scheduler forgot it in on_exit, only the memory is left
+				if(auto *task = exiting_) {
+					exiting_ = nullptr;
+					scheduler_callbacks::on_task_done(task);
+				}
+			}
+			if constexpr (sch::HasOnWake<scheduler_type>) {
+				sleep_queue::process([](control_block *task) { scheduler_.on_wake(task); });
+			}
+		}
+
 		static void task_idle() {
 		    while (true) {
+		    	free_released_tasks();
 		    	config::idle_hook();
-		        __WFI();
+		    	if constexpr (config_type::tickless_idle && (sch::HasNextWakeup<scheduler_type> || sch::HasOnWake<scheduler_type>)) {
+		    		impl_base::tickless_idle(&impl::next_wakeup);
+		    		// let the scheduler pick up the sleepers that are due now
+		    		kernel::api::yield();
+		    	}
+		    	else {
+		    		__WFI();
+		    	}
 		    }
 		}
 
+		static std::optional<std::uint32_t> next_wakeup() {
+			if constexpr (sch::HasNextWakeup<scheduler_type>) {
+				return scheduler_.next_wakeup();
+			}
+			else {
+				// event-driven: the sleepers are in the kernel queue only
+				return sleep_queue::next_wakeup();
+			}
+		}
+
+		// SysTick context. Equal or lower priority wakers wait for the end of the current quanta
+		static bool wakeup_check(control_block *current, control_block *waker) {
+			if((current == nullptr) || (current == &idle_.tcb)) {
+				return true;
+			}
+			if constexpr (sch::HasWakeupPreemption<scheduler_type>) {
+				return scheduler_.preempts(waker, current);
+			}
+			else {
+				return false;
+			}
+		}
+
+		// Thread mode only: the released tasks are not running and PendSV is done with them
+		static void free_released_tasks() {
+			if(released_ == nullptr) {
+				return;
+			}
+			control_block *list = nullptr;
+			{
+				sync::kernel_critical_section dirq;
+				list = released_;
+				released_ = nullptr;
+			}
+			while(list) {
+				auto *next = static_cast<control_block *>(list->scheduler_data);
+				auto *object = utils::container_of<tasks::heap_object>(list, &tasks::heap_object::tcb);
+				{
+					sync::kernel_critical_section dirq;
+					heap_list_type::remove(object);
+				}
+				tasks::heap_object::destroy(object);
+				list = next;
+			}
+		}
+
 		static void task_wrapper() {
 			auto tcb = kernel::api::get_current_tcb();
 			ASSERT(tcb, "No current TCB...");
@@ -118,26 +345,17 @@ namespace aikartos::kernel {
 				tcb->task.state = tasks::descriptor::state_type::RUNNING;
 				tcb->task.task(tcb->task.parameter);
 			}
-			tcb->task.state = tasks::descriptor::state_type::DONE;
-			kernel::api::yield();
+			kernel::api::terminate_current();
 		}
 
 		void task_object_staсk_init(control_block &tcb, int32_t task) {
 
 #if defined(PLATFORM_USE_FPU)
+			// A new task always starts with a basic frame.
+			// The extended one appears after its first FP instruction (FPCCR.ASPEN).
 			if(impl_base::get_task_fpu_default()) {
 				tcb.enable_fpu();
 			}
-#	ifdef DEBUG
-			tcb.push<std::uint32_t>(0xDEADBEEF); // deadbeef
-			tcb.push<std::uint32_t>(0xDEADBEEF); // deadbeef
-#	endif
-			tcb.push<std::uint32_t>(0xFA000000); // padding
-			tcb.push<std::uint32_t>(0xFB000000); // FPSCR
-
-			for(int i=0; i<16; ++i) {
-				tcb.push<std::uint32_t>(0xF0000000 + i);  //s0 - s15 registers
-			}
 #endif
 			tcb.push<std::uint32_t>(xPSR_T_Msk); // 0x01000000
 			tcb.push<std::uint32_t>(task);
@@ -163,6 +381,13 @@ namespace aikartos::kernel {
 		inline static utils::object_pool<task_object, maximum_tasks> pool_;
 		inline static scheduler_type scheduler_;
 		inline static tasks::object<400> idle_;
+		// Finished heap tasks, linked through scheduler_data (it's released by clear_task)
+		inline static control_block * volatile released_ = nullptr;
+		// Every live heap task, released ones included until they are destroyed
+		using heap_list_type = utils::intrusive_list<tasks::heap_object, &tasks::heap_object::all_node>;
+		inline static heap_list_type heap_tasks_;
+		// Event-driven schedulers: the task that reported on_exit, released in the next PendSV
+		inline static control_block *exiting_ = nullptr;
 
 	};
 }
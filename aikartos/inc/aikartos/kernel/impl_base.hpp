@@ -7,9 +7,10 @@
 
 #pragma once
 
-#include <tuple>
+#include <optional>
 
 #include "aikartos/kernel/config.hpp"
+#include "aikartos/sch/concepts.hpp"
 #include "aikartos/sch/events.hpp"
 #include "aikartos/sch/statistic.hpp"
 #include "aikartos/tasks/config.hpp"
@@ -27,26 +28,42 @@ namespace aikartos::kernel {
 
 		using systick_hook_parameter_type = void *;
 		using systick_hook_type = bool(*)(systick_hook_parameter_type);
+		using next_wakeup_type = std::optional<std::uint32_t>(*)();
+		using wakeup_check_type = bool(*)(control_block *current, control_block *waker);
 
 		virtual ~impl_base() = default;
 		virtual control_block *add_task(task_entry, task_parameter, const tasks::config &) = 0;
-		virtual std::tuple<control_block *, sch::scheduler_specific_event> get_next_task() = 0;
+		virtual control_block *get_next_task(sch::scheduler_specific_event &event) = 0;
+		virtual bool handoff(control_block *current, control_block *target) = 0;
 		virtual bool get_scheduler_statistic(sch::statistic_base &) = 0;
+		virtual bool get_tasks_statistic(sch::statistic_base &) = 0;
+
+		// Checked by SysTick for every woken task: true if 'waker' has to preempt 'current'
+		inline static wakeup_check_type get_wakeup_check() { return wakeup_check_; }
 
 #if defined(PLATFORM_USE_FPU)
 		inline static void set_task_fpu_default(bool value) { default_fpu_ = value; }
 		inline static bool get_task_fpu_default() { return default_fpu_; }
+		inline static void set_fpu_auto_enable(bool value) { fpu_auto_enable_ = value; }
+		inline static bool get_fpu_auto_enable() { return fpu_auto_enable_; }
 #endif
 
 	protected:
+		// Suppresses SysTick until the tick returned by 'next_wakeup' (or any other interrupt)
+		// and advances the tick counter by the time spent sleeping. Called by the idle task only.
+		static void tickless_idle(next_wakeup_type next_wakeup);
+
 		friend class kernel::core;
 		sch::events::handler_type scheduler_event_handler_ = nullptr;
 		systick_hook_type systick_hook_ = nullptr;
 		systick_hook_parameter_type systick_hook_parameter_ = nullptr;
 		inline static std::uint32_t quanta_ = 0;
 		inline static std::uint32_t default_quanta_ = 0;
+		inline static wakeup_check_type wakeup_check_ = nullptr;
 #if defined(PLATFORM_USE_FPU)
 		inline static bool volatile default_fpu_ = false;
+		// FPU access is granted per task on its first FP instruction (UsageFault NOCP)
+		inline static bool volatile fpu_auto_enable_ = false;
 #endif
 	};
 }
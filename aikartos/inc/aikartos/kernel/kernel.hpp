@@ -7,13 +7,21 @@
 
 #pragma once
 
+#include "aikartos/device/cycle_counter.hpp"
 #include "aikartos/kernel/core.hpp"
 #include "aikartos/kernel/api.hpp"
+#include "aikartos/kernel/scheduler_lock.hpp"
 
 namespace aikartos::kernel {
 
 	inline auto yield() -> void { return api::yield(); }
+	inline auto yield_to(core::task_block *task, bool donate = false) -> void { return api::yield_to(task, donate); }
 	inline auto get_tick_count() -> std::uint32_t { return core::get_tick_count(); }
+	inline auto get_timestamp_cycles() -> std::uint64_t { return core::get_timestamp_cycles(); }
+	inline auto get_timestamp_us() -> std::uint64_t { return core::get_timestamp_us(); }
+	// Busy-wait, the task keeps the CPU. Use sleep for anything longer than a tick
+	inline void delay_cycles(std::uint32_t cycles) { device::cycle_counter::delay_cycles(cycles); }
+	inline void delay_us(std::uint32_t microseconds) { device::cycle_counter::delay_us(microseconds); }
 
 	template <
 			template<typename...> typename SchedulerT,
@@ -40,14 +48,24 @@ namespace aikartos::kernel {
 		api::terminate_current(need_yield);
 	}
 
+#if defined(KERNEL_USE_PROFILING)
+	inline auto get_switch_profile() { return core::get_switch_profile(); }
+	inline void reset_switch_profile() { core::reset_switch_profile(); }
+#endif
+
 	inline bool has_fpu() { return core::has_fpu(); }
 	inline auto enable_fpu_hardware() { return core::enable_fpu_hardware(); }
 
 #if defined(PLATFORM_USE_FPU)
 		inline void set_task_fpu_default(bool value) { core::set_task_fpu_default(value); }
 		inline bool get_task_fpu_default() { return core::get_task_fpu_default(); }
+		// Tasks start without FPU access and get it on their first FP instruction.
+		// Must be set before launch()
+		inline void set_fpu_auto_enable(bool value) { core::set_fpu_auto_enable(value); }
+		inline bool get_fpu_auto_enable() { return core::get_fpu_auto_enable(); }
 #endif
 
 	inline void sleep(std::uint32_t millieconds) { kernel::api::sleep(millieconds); }
+	inline void sleep_until(std::uint32_t tick) { kernel::api::sleep_until(tick); }
 
 }
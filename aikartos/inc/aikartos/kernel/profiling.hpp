@@ -0,0 +1,71 @@
+/*
+ * profiling.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "aikartos/device/cycle_counter.hpp"
+#include "aikartos/utils/histogram.hpp"
+
+#if defined(KERNEL_USE_PROFILING)
+// DWT->CYCCNT at PendSV entry and exit, written by PendSV_Handler
+extern "C" volatile std::uint32_t g_pendsv_enter_cycles;
+extern "C" volatile std::uint32_t g_pendsv_exit_cycles;
+#endif
+
+namespace aikartos::kernel {
+
+	// Context switch costs in core clock cycles (KERNEL_USE_PROFILING)
+	struct switch_profile {
+		using histogram_type = utils::histogram<64, 16>; // 0..1023 cycles, the rest goes to the last bucket
+		histogram_type pendsv;		// PendSV_Handler from entry to exit, including same-task returns
+		histogram_type decision;	// get_next_task and the scheduler event handler
+	};
+
+#if defined(KERNEL_USE_PROFILING)
+	class profiler {
+	public:
+
+		static void start() {
+			device::cycle_counter::enable();
+			reset();
+		}
+
+		static void reset() {
+			profile_.pendsv.reset();
+			profile_.decision.reset();
+			has_previous_ = false;
+		}
+
+		static const switch_profile &get() {
+			return profile_;
+		}
+
+		// PendSV stamps its exit after the decision is made,
+		// so the duration of the previous PendSV is collected when the next one starts
+		inline static std::uint32_t on_decision_begin() {
+			const auto enter = g_pendsv_enter_cycles;
+			if(has_previous_) {
+				profile_.pendsv.add(g_pendsv_exit_cycles - previous_enter_);
+			}
+			previous_enter_ = enter;
+			has_previous_ = true;
+			return device::cycle_counter::now();
+		}
+
+		inline static void on_decision_end(std::uint32_t begin) {
+			profile_.decision.add(device::cycle_counter::now() - begin);
+		}
+
+	private:
+		inline static switch_profile profile_ = {};
+		inline static std::uint32_t previous_enter_ = 0;
+		inline static bool has_previous_ = false;
+	};
+#endif
+}
@@ -0,0 +1,74 @@
+/*
+ * scheduler_lock.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "aikartos/device/device.hpp"
+#include "aikartos/kernel/api.hpp"
+#include "aikartos/kernel/panic.hpp"
+
+namespace aikartos::kernel {
+
+	// Keeps the running task on the CPU without masking interrupts.
+	// A switch requested meanwhile (quanta, yield, wakeup) is taken on the outermost unlock.
+	// Nestable, task context only. The task must not sleep or wait while it holds the lock.
+	// Satisfies sync::policies::MutexPolicy, so it works with sync::lock_guard and the containers
+	class scheduler_lock {
+	public:
+
+		static void lock() {
+			DEBUG_ASSERT(!api::is_in_interrupt(), "scheduler_lock in an interrupt");
+			depth_ = depth_ + 1;
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+		}
+
+		static void unlock() {
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+			DEBUG_ASSERT(depth_ > 0, "scheduler_lock is not locked");
+			depth_ = depth_ - 1;
+			if((depth_ == 0) && deferred_) {
+				deferred_ = false;
+				SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+			}
+		}
+
+		static bool try_lock() {
+			lock();
+			return true;
+		}
+
+		static bool is_locked() {
+			return depth_ != 0;
+		}
+
+	private:
+
+		friend class core;
+
+		// PendSV: the switch is postponed until unlock
+		static void defer() {
+			deferred_ = true;
+		}
+
+		inline static volatile std::uint32_t depth_ = 0;
+		inline static volatile bool deferred_ = false;
+	};
+
+	struct scheduler_lock_guard {
+		scheduler_lock_guard() {
+			scheduler_lock::lock();
+		}
+		~scheduler_lock_guard() {
+			scheduler_lock::unlock();
+		}
+		scheduler_lock_guard(const scheduler_lock_guard &) = delete;
+		scheduler_lock_guard &operator = (const scheduler_lock_guard &) = delete;
+	};
+}
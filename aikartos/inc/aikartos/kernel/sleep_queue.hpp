@@ -0,0 +1,187 @@
+/*
+ * sleep_queue.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <optional>
+
+#include "aikartos/sync/kernel_critical_section.hpp"
+#include "aikartos/tasks/control_block.hpp"
+#include "aikartos/utils/container_of.hpp"
+#include "aikartos/utils/timing_wheel.hpp"
+
+namespace aikartos::kernel {
+
+	// The kernel timing wheel, shared by all the schedulers (see sch::waiting_tasks_queue).
+	// SysTick advances it. The expired tasks are queued until the scheduler picks them up in PendSV.
+	class sleep_queue {
+	public:
+		using control_block = tasks::control_block;
+		using wheel_type = utils::timing_wheel<5, 5>;
+
+		// Parks the task until task.timing.next_run
+		static void push(control_block *task) {
+			sync::kernel_critical_section dirq;
+			// a task may be put to sleep again with a new time, also one that has expired
+			// and is still in the woken queue: a node is in one place at a time
+			if(!wheel_.cancel(&task->wait_node)) {
+				unlink_woken(&task->wait_node);
+			}
+			task->wait_node.on_expire = &sleep_queue::on_task_expired;
+			if(task->task.state != tasks::descriptor::state_type::WAIT) {
+				// woken up (see wake) between its sleep request and the scheduler parking it
+				on_task_expired(&task->wait_node);
+				return;
+			}
+			wheel_.insert(&task->wait_node, task->task.timing.next_run);
+		}
+
+		// Ends the sleep before its time. Any context, including interrupts.
+		static void wake(control_block *task) {
+			sync::kernel_critical_section dirq;
+			if(wheel_.cancel(&task->wait_node)) {
+				on_task_expired(&task->wait_node);
+			}
+			else if(task->task.state == tasks::descriptor::state_type::WAIT) {
+				// not parked yet: the scheduler keeps it ready or push() queues it straight away
+				task->task.state = tasks::descriptor::state_type::READY;
+			}
+		}
+
+		// Takes the task out of the wheel, or out of the woken queue if it has expired
+		// and the scheduler hasn't picked it up yet. false if it's in neither
+		static bool cancel(control_block *task) {
+			sync::kernel_critical_section dirq;
+			return wheel_.cancel(&task->wait_node) || unlink_woken(&task->wait_node);
+		}
+
+		// Works on any node: tasks and timers share the wheel
+		static void insert(utils::timing_node *node, std::uint32_t expiry) {
+			sync::kernel_critical_section dirq;
+			wheel_.insert(node, expiry);
+		}
+
+		static bool cancel(utils::timing_node *node) {
+			sync::kernel_critical_section dirq;
+			return wheel_.cancel(node);
+		}
+
+		// SysTick and tickless idle
+		static void advance(std::uint32_t now) {
+			sync::kernel_critical_section dirq;
+			wheel_.advance(now);
+		}
+
+		// Moves the woken tasks out in the order they expired
+		template <typename CallBackT>
+		static void process(CallBackT cb) {
+			while(auto *task = pop_woken()) {
+				task->task.state = tasks::descriptor::state_type::READY;
+				cb(task);
+			}
+		}
+
+		// true if there are woken tasks that the scheduler hasn't picked up yet
+		static bool has_woken() {
+			sync::kernel_critical_section dirq;
+			return woken_head_ != nullptr;
+		}
+
+		// true if 'pred' holds for any woken task that the scheduler hasn't picked up yet
+		template <typename PredicateT>
+		static bool any_woken(PredicateT pred) {
+			sync::kernel_critical_section dirq;
+			for(auto *node = woken_head_; node != nullptr; node = node->next) {
+				if(pred(to_task(node))) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Sleeping and woken tasks
+		template <typename CallBackT>
+		static void foreach(CallBackT cb) {
+			sync::kernel_critical_section dirq;
+			wheel_.foreach([&cb](utils::timing_node *node) {
+				if(node->on_expire == &sleep_queue::on_task_expired) {
+					cb(to_task(node));
+				}
+			});
+			for(auto *node = woken_head_; node != nullptr; node = node->next) {
+				cb(to_task(node));
+			}
+		}
+
+		// The tick the idle task may sleep until
+		static std::optional<std::uint32_t> next_wakeup() {
+			sync::kernel_critical_section dirq;
+			if(woken_head_ != nullptr) {
+				return { wheel_.now() };
+			}
+			return wheel_.next_expiry();
+		}
+
+	private:
+
+		static control_block *to_task(utils::timing_node *node) {
+			return utils::container_of<control_block>(node, &control_block::wait_node);
+		}
+
+		// The woken queue is doubly linked through prev/next, head stays nullptr (not in the wheel)
+		static bool is_woken(const utils::timing_node *node) {
+			return !node->is_linked() && ((node->prev != nullptr) || (woken_head_ == node));
+		}
+
+		static void on_task_expired(utils::timing_node *node) {
+			node->prev = woken_tail_;
+			node->next = nullptr;
+			if(woken_tail_) {
+				woken_tail_->next = node;
+			}
+			else {
+				woken_head_ = node;
+			}
+			woken_tail_ = node;
+		}
+
+		static bool unlink_woken(utils::timing_node *node) {
+			if(!is_woken(node)) {
+				return false;
+			}
+			if(node->prev) {
+				node->prev->next = node->next;
+			}
+			else {
+				woken_head_ = node->next;
+			}
+			if(node->next) {
+				node->next->prev = node->prev;
+			}
+			else {
+				woken_tail_ = node->prev;
+			}
+			node->prev = nullptr;
+			node->next = nullptr;
+			return true;
+		}
+
+		static control_block *pop_woken() {
+			sync::kernel_critical_section dirq;
+			auto *node = woken_head_;
+			if(node == nullptr) {
+				return nullptr;
+			}
+			unlink_woken(node);
+			return to_task(node);
+		}
+
+		inline static wheel_type wheel_;
+		inline static utils::timing_node *woken_head_ = nullptr;
+		inline static utils::timing_node *woken_tail_ = nullptr;
+	};
+}
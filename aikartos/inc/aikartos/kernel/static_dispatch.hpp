@@ -0,0 +1,27 @@
+/*
+ * static_dispatch.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include "aikartos/kernel/core.hpp"
+#include "aikartos/kernel/panic.hpp"
+
+/*
+ * Replaces the weak pendsv_handler_impl of the kernel with one that calls the scheduler directly:
+ * no virtual call through impl_base, the whole decision can be inlined into the PendSV path.
+ * The arguments must be the same as in kernel::init<SchedulerT, ConfigT>(), DEBUG_ASSERT checks it on every switch.
+ * Use it once, at namespace scope of a single translation unit:
+ *
+ *	AIKARTOS_KERNEL_STATIC_DISPATCH(sch::round_robin::scheduler, config)
+ *
+ **/
+#define AIKARTOS_KERNEL_STATIC_DISPATCH(SchedulerT, ConfigT) \
+	extern "C" aikartos::tasks::control_block *pendsv_handler_impl() { \
+		DEBUG_ASSERT((aikartos::kernel::core::is_initialized_as<aikartos::kernel::impl<SchedulerT, ConfigT>>()), \
+				"AIKARTOS_KERNEL_STATIC_DISPATCH doesn't match kernel::init"); \
+		return aikartos::kernel::core::select_next_task<aikartos::kernel::impl<SchedulerT, ConfigT>>(); \
+	}
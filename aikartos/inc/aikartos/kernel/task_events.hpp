@@ -0,0 +1,27 @@
+/*
+ * task_events.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include "aikartos/tasks/control_block.hpp"
+
+namespace aikartos::kernel {
+
+	// State changes reported to an event-driven scheduler (sch::HasOnBlock and the others).
+	// impl fills the handlers in, a handler is nullptr if the scheduler doesn't take that event.
+	// Always called inside kernel_critical_section
+	struct task_events {
+		using handler_type = void(*)(tasks::control_block *);
+
+		// the task has just got WAIT, it's still running until the yield that follows
+		inline static handler_type on_block = nullptr;
+		// the task has just got DONE
+		inline static handler_type on_exit = nullptr;
+		// the running task gives up the rest of its quanta
+		inline static handler_type on_yield = nullptr;
+	};
+}
@@ -0,0 +1,217 @@
+/*
+ * timers.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "aikartos/kernel/api.hpp"
+#include "aikartos/kernel/core.hpp"
+#include "aikartos/kernel/panic.hpp"
+#include "aikartos/kernel/sleep_queue.hpp"
+#include "aikartos/sync/kernel_critical_section.hpp"
+#include "aikartos/utils/container_of.hpp"
+#include "aikartos/utils/timing_wheel.hpp"
+
+namespace aikartos::kernel {
+
+	class timer_service;
+
+	// Software timer. The callback runs in the timer service task, not in the interrupt.
+	// The object has to outlive its arming: static storage or the owner's stack frame that stops it first.
+	class timer {
+	public:
+		using parameter_type = void *;
+		using callback_type = void(*)(timer &, parameter_type);
+
+		timer(callback_type callback, parameter_type parameter = nullptr)
+			: callback_(callback)
+			, parameter_(parameter)
+		{
+			node_.on_expire = &timer::on_expire;
+		}
+
+		timer(const timer &) = delete;
+		timer &operator = (const timer &) = delete;
+
+		~timer() {
+			stop();
+		}
+
+		// The first call after 'delay_ms', then every 'period_ms' counted from the previous expiry,
+		// not from the callback, so the period does not drift. period_ms = 0 is a one-shot timer.
+		void start(std::uint32_t delay_ms, std::uint32_t period_ms = 0) {
+			sync::kernel_critical_section dirq;
+			unqueue();
+			sleep_queue::cancel(&node_);
+			delay_ = delay_ms;
+			period_ = period_ms;
+			sleep_queue::insert(&node_, core::get_tick_count() + delay_ms);
+		}
+
+		// Same delay and period, counted from now
+		void restart() {
+			start(delay_, period_);
+		}
+
+		// false if the timer was not armed. A callback that is already due is dropped as well
+		bool stop() {
+			sync::kernel_critical_section dirq;
+			const bool queued = unqueue();
+			return sleep_queue::cancel(&node_) || queued;
+		}
+
+		bool is_active() const {
+			return node_.is_linked() || queued_;
+		}
+
+		// Expiries the service task didn't manage to handle before the next one
+		std::uint32_t get_overruns() const {
+			return overruns_;
+		}
+
+		std::uint32_t get_period() const {
+			return period_;
+		}
+
+		// The tick the last expiry was due at; the callback runs later, when the service task gets the CPU
+		std::uint32_t get_expiry() const {
+			return expiry_;
+		}
+
+	private:
+
+		friend class timer_service;
+
+		static void on_expire(utils::timing_node *node);
+		bool unqueue();
+
+		callback_type callback_;
+		parameter_type parameter_;
+		utils::timing_node node_;
+		std::uint32_t delay_ = 0;
+		std::uint32_t period_ = 0;
+		std::uint32_t overruns_ = 0;
+		std::uint32_t expiry_ = 0;
+
+		// the service queue, see timer_service
+		timer *prev_ = nullptr;
+		timer *next_ = nullptr;
+		bool queued_ = false;
+	};
+
+	// Runs the expired timers' callbacks in its own task. launch() it once, before or after kernel::launch
+	class timer_service {
+	public:
+
+		static void launch(const tasks::config &config = tasks::config{}) {
+			DEBUG_ASSERT(!launched_, "timer service is already launched");
+			launched_ = true;
+			core::add_task(&timer_service::task_entry, config);
+		}
+
+		static bool is_launched() {
+			return launched_;
+		}
+
+	private:
+
+		friend class timer;
+
+		// SysTick context
+		static void push(timer *value) {
+			value->prev_ = tail_;
+			value->next_ = nullptr;
+			if(tail_) {
+				tail_->next_ = value;
+			}
+			else {
+				head_ = value;
+			}
+			tail_ = value;
+			value->queued_ = true;
+			if(task_) {
+				sleep_queue::wake(task_);
+			}
+		}
+
+		static void remove(timer *value) {
+			if(value->prev_) {
+				value->prev_->next_ = value->next_;
+			}
+			else {
+				head_ = value->next_;
+			}
+			if(value->next_) {
+				value->next_->prev_ = value->prev_;
+			}
+			else {
+				tail_ = value->prev_;
+			}
+			value->prev_ = nullptr;
+			value->next_ = nullptr;
+			value->queued_ = false;
+		}
+
+		static timer *pop() {
+			sync::kernel_critical_section dirq;
+			auto *value = head_;
+			if(value) {
+				remove(value);
+			}
+			return value;
+		}
+
+		static void task_entry(void *) {
+			task_ = api::get_current_tcb();
+			while(true) {
+				while(auto *value = pop()) {
+					value->callback_(*value, value->parameter_);
+				}
+				{
+					sync::kernel_critical_section dirq;
+					if(head_ != nullptr) {
+						continue;
+					}
+					// until push() wakes it up. The wheel only takes half of the tick range ahead
+					api::block_task(task_, core::get_tick_count() + idle_wait_ticks);
+				}
+				api::yield();
+			}
+		}
+
+		constexpr static std::uint32_t idle_wait_ticks = 0x7FFF'FFFF;
+
+		inline static tasks::control_block *task_ = nullptr;
+		inline static timer *head_ = nullptr;
+		inline static timer *tail_ = nullptr;
+		inline static bool launched_ = false;
+	};
+
+	// SysTick context, inside the wheel advance
+	inline void timer::on_expire(utils::timing_node *node) {
+		auto *self = utils::container_of<timer>(node, &timer::node_);
+		self->expiry_ = node->expiry;
+		if(self->period_ != 0) {
+			// from the previous expiry, not from now
+			sleep_queue::insert(&self->node_, self->node_.expiry + self->period_);
+		}
+		if(self->queued_) {
+			++self->overruns_;
+			return;
+		}
+		timer_service::push(self);
+	}
+
+	inline bool timer::unqueue() {
+		if(!queued_) {
+			return false;
+		}
+		timer_service::remove(this);
+		return true;
+	}
+}
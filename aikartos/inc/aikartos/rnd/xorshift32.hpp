@@ -24,6 +24,12 @@ namespace aikartos::rnd {
 			return x;
 		}
 
+		// [0, range) with a multiply and a shift instead of a division (D. Lemire).
+		// The bias is below range / 2^32
+		std::uint32_t next_below(std::uint32_t range) {
+			return static_cast<std::uint32_t>((std::uint64_t{ next() } * range) >> 32);
+		}
+
 		void reset_state(std::uint32_t seed = 0xABCDEFFF) {
 			state_ = seed ? seed : 0xABCDEFFF;
 		}
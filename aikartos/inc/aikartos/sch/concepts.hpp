@@ -0,0 +1,69 @@
+/*
+ * concepts.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ *  
+ */
+
+#pragma once 
+
+#include <concepts>
+#include <cstdint>
+#include <optional>
+
+#include "aikartos/tasks/control_block.hpp"
+
+namespace aikartos::sch {
+
+	// Optional parts of the scheduler interface.
+	// The kernel checks for them at compile time and falls back to the default behavior if they are missing.
+
+	template <typename SchT>
+	concept HasNextWakeup = requires(SchT s) {
+		{ s.next_wakeup() } -> std::same_as<std::optional<std::uint32_t>>;
+	};
+
+	// true if the woken task has to take the CPU from the running one right away.
+	// Without it a wakeup preempts only the idle task
+	template <typename SchT>
+	concept HasWakeupPreemption = requires(SchT s, tasks::control_block *waker, tasks::control_block *current) {
+		{ s.preempts(waker, current) } -> std::convertible_to<bool>;
+	};
+
+	// Directed yield (kernel::api::yield_to): true if 'target' may run next instead of the scheduler's own choice.
+	// The scheduler updates its bookkeeping as if it picked 'target' itself. Both tasks are runnable
+	template <typename SchT>
+	concept HasHandoff = requires(SchT s, tasks::control_block *current, tasks::control_block *target) {
+		{ s.handoff(current, target) } -> std::convertible_to<bool>;
+	};
+
+	// Event-driven schedulers: the kernel reports every state change, so the ready structures hold
+	// only runnable tasks and get_next_task never scans for WAIT or DONE.
+	// on_block: the task got WAIT, the kernel parks it in kernel::sleep_queue itself.
+	// on_wake: a parked task is due or woken up, called from PendSV before get_next_task.
+	// on_exit: the task got DONE, the kernel releases it (clear_task) once it has switched away.
+	// on_yield: the running task gives up the rest of its quanta.
+	// on_block, on_exit and on_yield run in the task's context inside kernel_critical_section.
+	// on_block and on_wake go together: without on_wake the scheduler drains the sleep queue itself
+	template <typename SchT>
+	concept HasOnBlock = requires(SchT s, tasks::control_block *task) {
+		s.on_block(task);
+	};
+
+	template <typename SchT>
+	concept HasOnWake = requires(SchT s, tasks::control_block *task) {
+		s.on_wake(task);
+	};
+
+	template <typename SchT>
+	concept HasOnExit = requires(SchT s, tasks::control_block *task) {
+		s.on_exit(task);
+	};
+
+	template <typename SchT>
+	concept HasOnYield = requires(SchT s, tasks::control_block *task) {
+		s.on_yield(task);
+	};
+
+}
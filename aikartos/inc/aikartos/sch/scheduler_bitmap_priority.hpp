@@ -0,0 +1,141 @@
+/**
+ * @file scheduler_bitmap_priority.hpp
+ * @brief Fixed Priority scheduler with O(1) decisions over up to 256 priority levels.
+ *
+ * - Each task is assigned a fixed priority at creation, 0 is the highest, config::priority_levels is the count.
+ * - A bitmap of the non-empty levels finds the highest ready one with CLZ (two for more than 32 levels).
+ * - Every level is a FIFO over the tasks' own ready_node, tasks of equal priority take turns.
+ * - Event-driven (sch::HasOnBlock and the others): the FIFOs hold runnable tasks only,
+ *   so block, wake and exit are O(1) insertions and removals.
+ *
+ * Same policy as fixed_priority without its level scan and its three levels limit.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include "aikartos/kernel/core.hpp"
+#include "aikartos/kernel/panic.hpp"
+#include "aikartos/tasks/config.hpp"
+#include "aikartos/tasks/object.hpp"
+#include "aikartos/utils/intrusive_list.hpp"
+#include "aikartos/utils/object_pool.hpp"
+#include "aikartos/utils/priority_bitmap.hpp"
+
+namespace aikartos::sch {
+
+	namespace bitmap_priority {
+
+		enum class config_flags: std::uint32_t {
+			priority = (1 << 0),
+		};
+
+		template <typename ConfigT, typename TasksEventsType>
+		class scheduler {
+		public:
+
+			using config = ConfigT;
+			constexpr static std::size_t maximum_tasks = config::maximum_tasks;
+			constexpr static std::size_t priority_levels = config::priority_levels;
+			static_assert(priority_levels > 0 && priority_levels <= 256, "1..256 priority levels");
+
+			using tasks_events_type = TasksEventsType;
+			using control_block = tasks::control_block;
+
+			struct scheduler_data_type {
+				std::uint8_t priority = 0;
+			};
+
+			using level_list_type = utils::intrusive_list<control_block, &control_block::ready_node>;
+
+			using scheduler_data_allocator = utils::object_pool<scheduler_data_type, maximum_tasks, 4>;
+
+			void configure_task(control_block *value, const tasks::config &cfg) {
+				auto *sch_data = data_allocator_.alloc();
+				value->scheduler_data = static_cast<void *>(sch_data);
+				std::uint32_t priority = 0;
+				cfg.update_value<config_flags::priority>(priority);
+				ASSERT(priority < priority_levels, "Bad priority value");
+				sch_data->priority = static_cast<std::uint8_t>(priority);
+			}
+
+			void clear_task(control_block *value) {
+				unlink(value);
+				data_allocator_.free(get_data(value));
+			}
+
+			void add_task(control_block *value) {
+				link_back(value);
+			}
+
+			// The head of the highest level goes to the back of its FIFO, equals take turns
+			control_block *get_next_task() {
+				const auto level = ready_levels_.highest();
+				if(level == ready_levels_.npos) {
+					return nullptr;
+				}
+				auto *task = levels_[level].front();
+				levels_[level].move_to_back(task);
+				return task;
+			}
+
+			void on_block(control_block *task) {
+				unlink(task);
+			}
+
+			void on_wake(control_block *task) {
+				link_back(task);
+			}
+
+			void on_exit(control_block *task) {
+				unlink(task);
+			}
+
+			// Only if no ready task outranks 'target', 'current' included: the directed yield never jumps a higher priority
+			bool handoff(control_block *, control_block *target) {
+				if(get_data(target)->priority > ready_levels_.highest()) {
+					return false;
+				}
+				// its turn is used, as if get_next_task picked it
+				levels_[get_data(target)->priority].move_to_back(target);
+				return true;
+			}
+
+			// 0 is the highest priority
+			bool preempts(control_block *waker, control_block *current) {
+				return get_data(waker)->priority < get_data(current)->priority;
+			}
+
+		private:
+
+			static scheduler_data_type *get_data(control_block *task) {
+				return task->template get_scheduler_data<scheduler_data_type>();
+			}
+
+			void link_back(control_block *task) {
+				if(level_list_type::contains(task)) {
+					return;
+				}
+				const auto priority = get_data(task)->priority;
+				levels_[priority].push_back(task);
+				ready_levels_.set(priority);
+			}
+
+			void unlink(control_block *task) {
+				if(!level_list_type::remove(task)) {
+					return;
+				}
+				const auto priority = get_data(task)->priority;
+				if(levels_[priority].empty()) {
+					ready_levels_.clear(priority);
+				}
+			}
+
+			level_list_type levels_[priority_levels];
+			utils::priority_bitmap<priority_levels> ready_levels_;
+			scheduler_data_allocator data_allocator_;
+		};
+	}
+}
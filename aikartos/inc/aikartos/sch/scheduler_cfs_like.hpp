@@ -3,10 +3,15 @@
  * @file scheduler_cfs_like.hpp
  * @brief Fair scheduler based on accumulated virtual runtime (vruntime), inspired by the Linux CFS.
  *
- * - Each task maintains a vruntime counter that tracks how much CPU time it has consumed.
+ * - Each task maintains a vruntime counter that tracks how much CPU time it has consumed,
+ *   in cycles scaled by its weight: a task with twice the weight ages half as fast (config_flags::nice).
  * - On every context switch, the current task's vruntime is incremented based on its execution time.
  * - The scheduler always selects the task with the smallest vruntime to run next.
- * - Sleeping tasks do not accumulate vruntime and thus appear "poorer" when they return - gaining priority.
+ * - Sleeping tasks do not accumulate vruntime, on wakeup they are placed at most half a latency period
+ *   behind min_vruntime: a bit ahead of the others, but a long sleep is not a CPU monopoly.
+ * - The slice is the task's weight share of the target latency, not shorter than the minimum granularity.
+ * - Event-driven (sch::HasOnBlock and the others): the indexed heap holds runnable tasks only,
+ *   the running task's new vruntime is fixed in place instead of a pop and a push.
  *
  *
  *  Created on: May 17, 2025
@@ -17,20 +22,60 @@
 
 #pragma once
 
+#include "aikartos/const/constants.hpp"
 #include "aikartos/kernel/core.hpp"
+#include "aikartos/kernel/panic.hpp"
 #include "aikartos/sch/events.hpp"
-#include "aikartos/sch/waiting_tasks_queue.hpp"
-#include "aikartos/sync/policies/no_mutex.hpp"
-#include "aikartos/sync/stable_priority_queue.hpp"
 #include "aikartos/tasks/config.hpp"
 #include "aikartos/tasks/object.hpp"
+#include "aikartos/utils/extent_storage.hpp"
+#include "aikartos/utils/indexed_heap.hpp"
 #include "aikartos/utils/object_pool.hpp"
 
+// Ticks. Every ready task runs once per this period while they fit with the minimum granularity
+#if !defined(SCHEDULER_CFS_TARGET_LATENCY)
+#	define SCHEDULER_CFS_TARGET_LATENCY 20
+#endif
+
+// Ticks. The shortest slice
+#if !defined(SCHEDULER_CFS_MIN_GRANULARITY)
+#	define SCHEDULER_CFS_MIN_GRANULARITY 4
+#endif
+
 namespace aikartos::sch {
 
 	namespace cfs_like {
 
 		enum class config_flags : std::uint32_t {
+			nice = (1 << 0), // -20 (the largest share) .. 19, 0 by default
+		};
+
+		constexpr std::int32_t nice_min = -20;
+		constexpr std::int32_t nice_max = 19;
+		constexpr std::uint32_t nice_0_weight = 1024;
+
+		// Linux sched_prio_to_weight: every nice step is ~10% of CPU time against a nice 0 task
+		constexpr std::uint32_t nice_to_weight[] = {
+			88761, 71755, 56483, 46273, 36291,
+			29154, 23254, 18705, 14949, 11916,
+			 9548,  7620,  6100,  4904,  3906,
+			 3121,  2501,  1991,  1586,  1277,
+			 1024,   820,   655,   526,   423,
+			  335,   272,   215,   172,   137,
+			  110,    87,    70,    56,    45,
+			   36,    29,    23,    18,    15,
+		};
+
+		// 2^32 / weight: vruntime is scaled with a multiplication and a shift, no 64-bit division
+		constexpr std::uint32_t nice_to_wmult[] = {
+			     48388,     59856,     76040,     92818,    118348,
+			    147320,    184698,    229616,    287308,    360437,
+			    449829,    563644,    704093,    875809,   1099582,
+			   1376151,   1717300,   2157191,   2708050,   3363326,
+			   4194304,   5237765,   6557202,   8165337,  10153587,
+			  12820798,  15790321,  19976592,  24970740,  31350126,
+			  39045157,  49367440,  61356676,  76695844,  95443717,
+			 119304647, 148102320, 186737708, 238609294, 286331153,
 		};
 
 		template<typename ConfigT, typename TasksEventsType>
@@ -41,85 +86,107 @@ namespace aikartos::sch {
 
 			constexpr static std::size_t maximum_tasks = config::maximum_tasks;
 
+			constexpr static std::uint32_t target_latency = SCHEDULER_CFS_TARGET_LATENCY;
+			constexpr static std::uint32_t min_granularity = SCHEDULER_CFS_MIN_GRANULARITY;
+			static_assert(min_granularity > 0 && min_granularity <= target_latency, "Bad CFS latency settings");
+
+			constexpr static std::uint64_t cycles_per_tick = std::uint64_t{ constants::system_clock_frequency } / 1'000'000 * constants::tick_period_us;
+
 			using control_block = tasks::control_block;
 			using tasks_events_type = TasksEventsType;
 
 			struct scheduler_data_type {
-				std::uint32_t vruntime = 0;
-				std::uint32_t start = 0;
+				// nice 0 cycles, never wraps
+				std::uint64_t vruntime = 0;
+				std::uint64_t start = 0;
+				std::uint32_t weight = nice_0_weight;
+				std::uint32_t wmult = 0;
+				// equal vruntimes take turns, like the stable queue did
+				std::uint32_t order = 0;
 			};
 
 			using data_object_pool = utils::object_pool<scheduler_data_type, maximum_tasks, 4>;
-			using ready_tasks_queue = sync::stable_priority_queue<control_block *, maximum_tasks, vruntime_less, sync::policies::no_mutex>;
-			using waiting_queue = waiting_tasks_queue<maximum_tasks, sync::policies::no_mutex>;
+			using ready_tasks_queue = utils::indexed_heap<control_block, maximum_tasks, vruntime_less, &control_block::heap_index>;
 
-			void configure_task(control_block *task, const tasks::config&) {
-				task->scheduler_data = static_cast<void*>(data_pool_.alloc());
+			void configure_task(control_block *task, const tasks::config &cfg) {
+				auto *data = data_pool_.alloc();
+				task->scheduler_data = static_cast<void*>(data);
+
+				std::int32_t nice = 0;
+				cfg.update_value<config_flags::nice>(nice);
+				ASSERT((nice >= nice_min) && (nice <= nice_max), "Bad value for 'nice'");
+				data->weight = nice_to_weight[nice - nice_min];
+				data->wmult = nice_to_wmult[nice - nice_min];
+				// a new task starts level with the others, not with the whole history ahead of it
+				data->vruntime = min_vruntime_;
+
+				// on_wake runs in PendSV, the heap slot has to be there already
+				const bool reserved = ready_tasks_.reserve(++tasks_count_);
+				ASSERT(reserved, "Not enough memory for the ready queue");
 			}
 
 			void clear_task(control_block *task) {
+				leave(task);
+				tasks_count_--;
 				data_pool_.free(get_data(task));
 			}
 
 			control_block* get_next_task() {
-				process_waiting_queue();
-				const auto current_ticks = kernel::core::get_tick_count();
-
-				// we have the current task on the top.
-				// recalculating task;
-				if (auto current = ready_tasks_.try_pop()) {
-					auto *task = *current;
-					auto data = get_data(task);
-					if (data->start != 0) {
-						data->vruntime += (current_ticks - data->start);
-					}
-					ready_tasks_.try_push(task);
+				const auto now = kernel::core::get_timestamp_cycles();
+
+				// the previous pick pays for its run
+				if (running_ != nullptr) {
+					charge(running_, now);
+					ready_tasks_.update(running_);
 				}
+				update_min_vruntime();
 #ifdef DEBUG
 				fill_vrun_times();
 #endif
-				// try the next task
-				while (auto next_task = ready_tasks_.peek()) {
-					auto *task = *next_task;
-
-					switch (task->task.state) {
-					case tasks::descriptor::state_type::READY:
-						[[fallthrough]];
-					case tasks::descriptor::state_type::RUNNING:
-						get_data(task)->start = current_ticks;
-						return task;
-					case tasks::descriptor::state_type::DONE:
-						// It's done. Remove it from the queue
-						get_data(task)->start = 0;
-						ready_tasks_.try_pop();
-						tasks_events_type::on_task_done(task);
-						break;
-					case tasks::descriptor::state_type::WAIT:
-						// It's waiting. Remove it from the queue and put it in waiting_tasks_.
-						get_data(task)->start = 0;
-						ready_tasks_.try_pop();
-						waiting_tasks_.try_push(task);
-						break;
-					default:
-						break;
-					}
+				running_ = ready_tasks_.top();
+				if (running_ != nullptr) {
+					get_data(running_)->start = now;
+					tasks_events_type::on_quanta_change(get_slice(running_));
 				}
-
-				return nullptr;
+				return running_;
 			}
 
 			void add_task(control_block *task) {
-				ready_tasks_.try_push(task);
+				if (ready_tasks_.contains(task)) {
+					return;
+				}
+				auto *data = get_data(task);
+				data->order = ++order_;
+				total_weight_ += data->weight;
+				ready_tasks_.push(task);
 #ifdef DEBUG
 				fill_vrun_times();
 #endif
 			}
 
+			void on_block(control_block *task) {
+				leave(task);
+			}
+
+			void on_wake(control_block *task) {
+				place_sleeper(task);
+				add_task(task);
+			}
+
+			void on_exit(control_block *task) {
+				leave(task);
+			}
+
 		private:
 
 			struct vruntime_less {
 				bool operator ()(control_block *lhs, control_block *rhs) const {
-					return get_data(rhs)->vruntime < get_data(lhs)->vruntime;
+					const auto *l = get_data(lhs);
+					const auto *r = get_data(rhs);
+					if (l->vruntime != r->vruntime) {
+						return l->vruntime < r->vruntime;
+					}
+					return static_cast<std::int32_t>(l->order - r->order) < 0;
 				}
 			};
 
@@ -127,26 +194,84 @@ namespace aikartos::sch {
 				return task->get_scheduler_data<scheduler_data_type>();
 			}
 
-			void process_waiting_queue() {
-				waiting_tasks_.process([this](auto *task) {
-					add_task(task);
-				});
+			// delta * nice_0_weight / weight
+			static std::uint64_t scale(std::uint64_t delta, const scheduler_data_type *data) {
+				if (data->weight == nice_0_weight) {
+					return delta;
+				}
+				if (delta <= 0xFFFF'FFFF) {
+					// wmult = 2^32 / weight, nice_0_weight = 2^10
+					return (delta * data->wmult) >> 22;
+				}
+				return delta * nice_0_weight / data->weight;
+			}
+
+			void charge(control_block *task, std::uint64_t now) {
+				auto *data = get_data(task);
+				data->vruntime += scale(now - data->start, data);
+				data->start = now;
+				data->order = ++order_;
+			}
+
+			// Only grows: the smallest of the ready tasks, the running one included
+			void update_min_vruntime() {
+				if (auto *top = ready_tasks_.top()) {
+					const auto vruntime = get_data(top)->vruntime;
+					if (vruntime > min_vruntime_) {
+						min_vruntime_ = vruntime;
+					}
+				}
+			}
+
+			// Half a latency period of credit, no more
+			void place_sleeper(control_block *task) {
+				constexpr std::uint64_t credit = target_latency * cycles_per_tick / 2;
+				auto *data = get_data(task);
+				const auto floor = (min_vruntime_ > credit) ? (min_vruntime_ - credit) : 0;
+				if (data->vruntime < floor) {
+					data->vruntime = floor;
+				}
+			}
+
+			// Ticks: the weight share of the period, the period stretches when the minimum doesn't fit
+			std::uint32_t get_slice(control_block *task) const {
+				const auto count = static_cast<std::uint32_t>(ready_tasks_.size());
+				const auto period = (count > target_latency / min_granularity) ? (count * min_granularity) : target_latency;
+				const auto slice = static_cast<std::uint32_t>(std::uint64_t{ period } * get_data(task)->weight / total_weight_);
+				return (slice < min_granularity) ? min_granularity : slice;
+			}
+
+			// Blocked or done: it's charged up to now and leaves the heap
+			void leave(control_block *task) {
+				if (task == running_) {
+					charge(task, kernel::core::get_timestamp_cycles());
+					running_ = nullptr;
+				}
+				if (ready_tasks_.erase(task)) {
+					total_weight_ -= get_data(task)->weight;
+				}
 			}
 
 #ifdef DEBUG
 			void fill_vrun_times() {
 				std::size_t id = 0;
 				ready_tasks_.foreach([this, &id](control_block *task) {
-					current_vruns[id++] = get_data(task)->vruntime;
+					if (current_vruns.reserve(id + 1)) {
+						current_vruns[id++] = get_data(task)->vruntime;
+					}
 				});
-				for (; id < maximum_tasks; ++id) {
+				for (; id < current_vruns.size(); ++id) {
 					current_vruns[id] = 0;
 				}
 			}
-			std::uint32_t current_vruns[maximum_tasks];
+			utils::extent_storage<std::uint64_t, maximum_tasks> current_vruns;
 #endif
 			ready_tasks_queue ready_tasks_;
-			waiting_queue waiting_tasks_;
+			control_block *running_ = nullptr;
+			std::uint64_t min_vruntime_ = 0;
+			std::uint32_t total_weight_ = 0;
+			std::uint32_t order_ = 0;
+			std::size_t tasks_count_ = 0;
 			data_object_pool data_pool_;
 		};
 
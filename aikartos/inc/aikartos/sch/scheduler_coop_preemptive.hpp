@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "aikartos/kernel/panic.hpp"
 #include "aikartos/sch/waiting_tasks_queue.hpp"
 #include "aikartos/sync/policies/no_mutex.hpp"
 #include "aikartos/sync/circular_queue.hpp"
@@ -55,9 +56,14 @@ namespace aikartos::sch {
 				task->scheduler_data = static_cast<void *>(data);
 				data->quanta = kernel::core::get_default_quanta();
 				cfg.update_value<config_flags::quanta>(data->quanta);
+
+				// the queue is refilled in PendSV, it has to hold all the tasks already
+				const bool reserved = ready_tasks_.reserve(++tasks_count_);
+				ASSERT(reserved, "Not enough memory for the ready queue");
 			}
 
 			void clear_task(control_block *task) {
+				tasks_count_--;
 				data_allocator_.free(task->get_scheduler_data<scheduler_data_type>());
 			}
 
@@ -71,7 +77,7 @@ namespace aikartos::sch {
 					case tasks::descriptor::state_type::READY:
 						[[fallthrough]];
 					case tasks::descriptor::state_type::RUNNING:
-						ready_tasks_.try_push(task);
+						push_ready(task);
 						tasks_events_type::on_quanta_change(get_quanta(task));
 						return task;
 					case tasks::descriptor::state_type::DONE:
@@ -89,7 +95,11 @@ namespace aikartos::sch {
 			}
 
 			void add_task(control_block *value) {
-				ready_tasks_.try_push(value);
+				push_ready(value);
+			}
+
+			std::optional<std::uint32_t> next_wakeup() {
+				return waiting_tasks_.next_wakeup();
 			}
 
 		private:
@@ -99,10 +109,18 @@ namespace aikartos::sch {
 			}
 
 			void process_waiting_queue() {
-				waiting_tasks_.process([this](auto *task){ ready_tasks_.try_push(task); });
+				waiting_tasks_.process([this](auto *task){ push_ready(task); });
+			}
+
+			// Never allocates, configure_task has reserved the room
+			void push_ready(control_block *task) {
+				if(!ready_tasks_.try_push(task)) {
+					PANIC("Ready queue overflow");
+				}
 			}
 
 			task_block_queue_type ready_tasks_;
+			std::size_t tasks_count_ = 0;
 			waiting_queue waiting_tasks_;
 			scheduler_data_allocator data_allocator_;
 		};
@@ -6,6 +6,8 @@
  * - The scheduler always selects the READY task with the nearest (earliest) deadline.
  * - Deadlines can be updated on task wake-up or manually via task configuration.
  * - Ideal for systems with hard or soft real-time requirements where deadline order matters.
+ * - Event-driven (sch::HasOnBlock and the others): the indexed heap holds runnable tasks only,
+ *   a decision is a look at its top.
  *
  * This implementation ensures that time-critical tasks are executed in order of urgency,
  * improving predictability in deadline-driven systems.
@@ -16,11 +18,12 @@
 
 #pragma once
 
-#include "aikartos/sch/waiting_tasks_queue.hpp"
-#include "aikartos/sync/policies/no_mutex.hpp"
-#include "aikartos/sync/priority_queue.hpp"
+#include "aikartos/kernel/core.hpp"
+#include "aikartos/sch/events.hpp"
 #include "aikartos/tasks/config.hpp"
 #include "aikartos/tasks/control_block.hpp"
+#include "aikartos/utils/indexed_heap.hpp"
+#include "aikartos/utils/object_pool.hpp"
 
 namespace aikartos::sch {
 
@@ -52,74 +55,67 @@ namespace aikartos::sch {
 				task->scheduler_data = static_cast<void *>(sch_data);
 				cfg.update_value<config_flags::relative_deadline>(sch_data->deadline);
 				sch_data->deadline += kernel::core::get_tick_count();
+				// on_wake runs in PendSV, the heap slot has to be there already
+				const bool reserved = deadline_queue_.reserve(++tasks_count_);
+				ASSERT(reserved, "Not enough memory for the deadline queue");
 			}
 
 			void clear_task(control_block *value) {
+				deadline_queue_.erase(value);
+				tasks_count_--;
 				data_allocator_.free(get_data(value));
 			}
 
 			struct deadline_compare {
 				bool operator ()(control_block *lhs, control_block *rhs) const {
-					return get_data(rhs)->deadline < get_data(lhs)->deadline;
+					return get_data(lhs)->deadline < get_data(rhs)->deadline;
 				}
 			};
 
-			using deadline_queue = sync::priority_queue<control_block *, maximum_tasks, deadline_compare, sync::policies::no_mutex>;
-			using waiting_queue = waiting_tasks_queue<maximum_tasks, sync::policies::no_mutex>;
+			using deadline_queue = utils::indexed_heap<control_block, maximum_tasks, deadline_compare, &control_block::heap_index>;
 
 			void add_task(control_block *value) {
-				deadline_queue_.try_push(value);
+				if(!deadline_queue_.contains(value)) {
+					deadline_queue_.push(value);
+				}
+			}
+
+			void on_block(control_block *task) {
+				deadline_queue_.erase(task);
+			}
+
+			void on_wake(control_block *task) {
+				add_task(task);
+			}
+
+			void on_exit(control_block *task) {
+				deadline_queue_.erase(task);
 			}
 
 			std::tuple<control_block *, sch::scheduler_specific_event> get_next_task() {
-				process_waiting_queue();
-
-				const auto current_ticks = kernel::core::get_tick_count();
-
-				while(auto next_task = deadline_queue_.try_pop()) {
-					auto *task = *next_task;
-					auto task_deadline = get_data(task)->deadline;
-
-					if((task->task.state != tasks::descriptor::state_type::DONE)
-							&& (task_deadline <= current_ticks)) {
-						deadline_queue_.try_push(task);
-						return { task, 100 };
-					}
-
-					switch(task->task.state) {
-					case tasks::descriptor::state_type::READY:
-						[[fallthrough]];
-					case tasks::descriptor::state_type::RUNNING:
-						/// process expired deadline somehow?
-						deadline_queue_.try_push(task);
-						return { task, sch::events::OK };
-					case tasks::descriptor::state_type::DONE:
-						tasks_events_type::on_task_done(task);
-						break;
-					case tasks::descriptor::state_type::WAIT:
-						waiting_tasks_.try_push(task);
-						break;
-					default:
-						break;
-					}
+				auto *task = deadline_queue_.top();
+				if(task == nullptr) {
+					return { nullptr, sch::events::OK };
+				}
+				if(get_data(task)->deadline <= kernel::core::get_tick_count()) {
+					return { task, 100 };
 				}
+				return { task, sch::events::OK };
+			}
 
-				return { nullptr, sch::events::OK };
+			bool preempts(control_block *waker, control_block *current) {
+				return get_data(waker)->deadline < get_data(current)->deadline;
 			}
 
 		private:
 
-			void process_waiting_queue() {
-				waiting_tasks_.process([this](auto *task) { add_task(task); });
-			}
-
 			static scheduler_data_type *get_data(control_block *value) {
 				return value->template get_scheduler_data<scheduler_data_type>();
 			}
 
 			scheduler_data_allocator data_allocator_;
 			deadline_queue deadline_queue_;
-			waiting_queue waiting_tasks_;
+			std::size_t tasks_count_ = 0;
 		};
 
 	}
@@ -59,9 +59,17 @@ namespace aikartos::sch {
 				value->scheduler_data = static_cast<void *>(sch_data);
 				cfg.update_value<config_flags::priority>(sch_data->priority);
 				ASSERT(sch_data->priority < maximum_priority, "Bad priority value");
+
+				// the queues are refilled in PendSV, every one has to hold all the tasks already
+				++tasks_count_;
+				for(auto &queue: ready_tasks_) {
+					const bool reserved = queue.reserve(tasks_count_);
+					ASSERT(reserved, "Not enough memory for the ready queues");
+				}
 			}
 
 			void clear_task(control_block *value) {
+				tasks_count_--;
 				data_allocator_.free(value->template get_scheduler_data<scheduler_data_type>());
 			}
 
@@ -70,7 +78,7 @@ namespace aikartos::sch {
 			void add_task(control_block *value) {
 				const auto priority_id = static_cast<std::size_t>(value->template get_scheduler_data<scheduler_data_type>()->priority);
 				DEBUG_ASSERT(priority_id < maximum_priority, "Bad task priority.");
-				ready_tasks_[priority_id].try_push(value);
+				push_ready(ready_tasks_[priority_id], value);
 			}
 
 			control_block *get_next_task() {
@@ -85,7 +93,7 @@ namespace aikartos::sch {
 						case tasks::descriptor::state_type::READY:
 							[[fallthrough]];
 						case tasks::descriptor::state_type::RUNNING:
-							queue.try_push(task);
+							push_ready(queue, task);
 							return task;
 						case tasks::descriptor::state_type::DONE:
 							tasks_events_type::on_task_done(task);
@@ -101,13 +109,40 @@ namespace aikartos::sch {
 				return nullptr;
 			}
 
+			std::optional<std::uint32_t> next_wakeup() {
+				return waiting_tasks_.next_wakeup();
+			}
+
+			// Never to a lower priority than 'current'. The higher queues are not checked, they may still hold
+			// tasks that have blocked since, so a ready task above 'current' can be jumped until the next decision
+			bool handoff(control_block *current, control_block *target) {
+				return get_data(target)->priority <= get_data(current)->priority;
+			}
+
+			// 0 is the highest priority
+			bool preempts(control_block *waker, control_block *current) {
+				return get_data(waker)->priority < get_data(current)->priority;
+			}
+
 		private:
 
+			static scheduler_data_type *get_data(control_block *task) {
+				return task->template get_scheduler_data<scheduler_data_type>();
+			}
+
+			// Never allocates, configure_task has reserved the room
+			static void push_ready(ready_block_queue_type &queue, control_block *task) {
+				if(!queue.try_push(task)) {
+					PANIC("Ready queue overflow");
+				}
+			}
+
 			void process_waiting_queue() {
 				waiting_tasks_.process([this](auto *task){ add_task(task); });
 			}
 
 			ready_array_type ready_tasks_;
+			std::size_t tasks_count_ = 0;
 			waiting_queue waiting_tasks_;
 			scheduler_data_allocator data_allocator_;
 		};
@@ -6,6 +6,7 @@
  * - On each scheduling decision, a random draw selects one task proportionally to its ticket count.
  * - Tasks with more tickets have a higher probability of being selected.
  * - Simple form of probabilistic fairness that supports dynamic balancing via ticket adjustment.
+ * - A Fenwick tree over the ready slots makes the draw O(log n), the range reduction is a multiply and a shift.
  *
  *  Created on: May 11, 2025
  *      Author: newenclave
@@ -16,10 +17,10 @@
 #include "aikartos/kernel/core.hpp"
 #include "aikartos/rnd/lfsr.hpp"
 #include "aikartos/rnd/xorshift32.hpp"
-#include "aikartos/sch/waiting_tasks_queue.hpp"
-#include "aikartos/sync/policies/no_mutex.hpp"
 #include "aikartos/tasks/config.hpp"
 #include "aikartos/tasks/control_block.hpp"
+#include "aikartos/utils/extent_storage.hpp"
+#include "aikartos/utils/fenwick_tree.hpp"
 
 namespace aikartos::sch {
 
@@ -29,6 +30,8 @@ namespace aikartos::sch {
 			tickets = (1 << 0),
 		};
 
+		// Event-driven (sch::HasOnBlock and the others): the ready array holds runnable tasks only,
+		// packed at the front. Every task knows its slot, so block and exit are O(1) removals.
 		template <typename ConfigT, typename TasksEventsType>
 		class scheduler {
 		public:
@@ -41,11 +44,12 @@ namespace aikartos::sch {
 
 			struct scheduler_data_type {
 				std::uint8_t tickets = 1;
+				bool ready = false;
+				std::uint16_t slot = 0;
 			};
 
 			using scheduler_data_allocator = utils::object_pool<scheduler_data_type, maximum_tasks, 4>;
-			using waiting_queue = waiting_tasks_queue<maximum_tasks, sync::policies::no_mutex>;
-			using ready_array = std::array<control_block *, maximum_tasks>;
+			using ready_array = utils::extent_storage<control_block *, maximum_tasks>;
 
 			void configure_task(control_block *task, const tasks::config &cfg) {
 				auto *sch_data = data_allocator_.alloc();
@@ -54,76 +58,64 @@ namespace aikartos::sch {
 				cfg.update_value<config_flags::tickets>(sch_data->tickets);
 				ASSERT(sch_data->tickets > 0, "Bad value for 'lottery_tickets'");
 
+				// on_wake runs in PendSV, the slot has to be there already
+				const bool reserved = ready_.reserve(tasks_count_ + 1) && tickets_.reserve(tasks_count_ + 1);
+				ASSERT(reserved, "Not enough memory for the ready array");
+				tasks_count_++;
 			}
 
 			void clear_task(control_block *task) {
 				remove_task(task);
+				tasks_count_--;
 				data_allocator_.free(get_data(task));
 			}
 
 			control_block* get_next_task() {
-				process_waiting_queue();
-
-				if(total_tickets_ > 0) {
-					const auto next_win = (rng_.next() % total_tickets_);
-					std::uint32_t current_tickets = 0;
-					std::size_t task_checked = 0;
-					for(std::size_t i = 0; (i < ready_.size()) && (task_checked < ready_count_); i++) {
-						if(nullptr != ready_[i]) {
-							task_checked++;
-							auto *task = ready_[i];
-							const auto tickets = get_tickets(task);
-							switch(task->task.state) {
-							case tasks::descriptor::state_type::READY:
-								[[fallthrough]];
-							case tasks::descriptor::state_type::RUNNING:
-								current_tickets += tickets;
-								if(next_win < current_tickets) {
-									return task;
-								}
-								break;
-							case tasks::descriptor::state_type::DONE:
-								tasks_events_type::on_task_done(task);
-								break;
-							case tasks::descriptor::state_type::WAIT:
-								remove_task(task);
-								waiting_tasks_.try_push(task);
-								break;
-							default:
-								break;
-							}
-						}
-					}
-
+				const auto total_tickets = tickets_.total();
+				if(total_tickets == 0) {
+					return nullptr;
 				}
-
-				return nullptr;
+				return ready_[tickets_.find(rng_.next_below(total_tickets))];
 			}
 
 			void add_task(control_block *task) {
-				auto tickets = get_tickets(task);
-				for(std::size_t i = 0; i < ready_.size(); i++) {
-					if(nullptr == ready_[i]) {
-						ready_count_++;
-						total_tickets_ += tickets;
-						ready_[i] = task;
-						break;
-					}
+				auto *data = get_data(task);
+				if(data->ready) {
+					return;
 				}
+				data->ready = true;
+				data->slot = static_cast<std::uint16_t>(ready_count_);
+				tickets_.set(ready_count_, data->tickets);
+				ready_[ready_count_++] = task;
+			}
+
+			void on_block(control_block *task) {
+				remove_task(task);
+			}
+
+			void on_wake(control_block *task) {
+				add_task(task);
+			}
+
+			void on_exit(control_block *task) {
+				remove_task(task);
 			}
 
 		private:
 
 			void remove_task(control_block *task) {
-				auto tickets = get_tickets(task);
-				for(std::size_t i = 0; i < ready_.size(); i++) {
-					if(task == ready_[i]) {
-						ready_count_--;
-						total_tickets_ -= tickets;
-						ready_[i] = nullptr;
-						break;
-					}
+				auto *data = get_data(task);
+				if(!data->ready) {
+					return;
 				}
+				data->ready = false;
+				// the last one takes the free slot
+				auto *last = ready_[--ready_count_];
+				ready_[data->slot] = last;
+				get_data(last)->slot = data->slot;
+				ready_[ready_count_] = nullptr;
+				tickets_.set(data->slot, get_tickets(last));
+				tickets_.set(ready_count_, 0);
 			}
 
 			static scheduler_data_type *get_data(control_block *task) {
@@ -134,15 +126,12 @@ namespace aikartos::sch {
 				return get_data(task)->tickets;
 			}
 
-			void process_waiting_queue() {
-				waiting_tasks_.process([this](auto *task){ add_task(task); });
-			}
-
 			rnd::xorshift32 rng_;
-			std::size_t ready_count_;
-			std::uint32_t total_tickets_ = 0;
-			waiting_queue waiting_tasks_;
+			std::size_t ready_count_ = 0;
+			std::size_t tasks_count_ = 0;
 			ready_array ready_ {};
+			// per ready slot, 0 past ready_count_
+			utils::fenwick_tree<maximum_tasks> tickets_;
 			scheduler_data_allocator data_allocator_;
 		};
 	}
@@ -17,13 +17,14 @@
 #pragma once 
 
 #include "aikartos/kernel/core.hpp"
+#include "aikartos/kernel/panic.hpp"
+#include "aikartos/kernel/scheduler_lock.hpp"
 #include "aikartos/sch/events.hpp"
 #include "aikartos/sch/waiting_tasks_queue.hpp"
 #include "aikartos/sch/statistic.hpp"
 
 #include "aikartos/sync/policies/no_mutex.hpp"
 #include "aikartos/sync/priority_queue.hpp"
-#include "aikartos/sync/irq_critical_section.hpp"
 
 #include "aikartos/tasks/config.hpp"
 #include "aikartos/tasks/object.hpp"
@@ -105,9 +106,17 @@ namespace aikartos::sch {
 					sch_data->levels[2] = ql_ptr->low;
 				};
 				cfg.update_value<config_flags::boost_quanta>(sch_data->boost_quanta);
+
+				// the queues are refilled in PendSV, every one has to hold all the tasks already
+				++tasks_count_;
+				for(auto &level: levels_) {
+					const bool reserved = level.reserve(tasks_count_);
+					ASSERT(reserved, "Not enough memory for the level queues");
+				}
 			}
 
 			void clear_task(control_block *task) {
+				tasks_count_--;
 				data_pool_.free(get_data(task));
 			}
 
@@ -134,12 +143,12 @@ namespace aikartos::sch {
 			}
 
 			void add_task(control_block *task) {
-				levels_[get_data(task)->level].try_push(task);
+				push_ready(task);
 			}
 
 			bool get_statistic(sch::statistic_base &stat) {
-				// disabling IRQs here
-				sync::irq_critical_section irqd;
+				// no switches meanwhile, the interrupts stay enabled
+				kernel::scheduler_lock_guard lock;
 				std::size_t current_task_id = 0;
 
 				const auto get_stat = [this, &current_task_id, &stat](auto *task) {
@@ -163,6 +172,15 @@ namespace aikartos::sch {
 				return true;
 			}
 
+			std::optional<std::uint32_t> next_wakeup() {
+				return waiting_tasks_.next_wakeup();
+			}
+
+			// level 0 is the most interactive one
+			bool preempts(control_block *waker, control_block *current) {
+				return get_data(waker)->level < get_data(current)->level;
+			}
+
 		private:
 
 			void boost_levels() {
@@ -185,10 +203,8 @@ namespace aikartos::sch {
 					switch(task->task.state) {
 					case tasks::descriptor::state_type::READY:
 						[[fallthrough]];
-					case tasks::descriptor::state_type::RUNNING: {
-						const auto level = get_data(task)->level;
-						levels_[level].try_push(task);
-						}
+					case tasks::descriptor::state_type::RUNNING:
+						push_ready(task);
 						return task;
 					case tasks::descriptor::state_type::DONE:
 						tasks_events_type::on_task_done(task);
@@ -204,6 +220,13 @@ namespace aikartos::sch {
 				return nullptr;
 			}
 
+			// Never allocates, configure_task has reserved the room
+			void push_ready(control_block *task) {
+				if(!levels_[get_data(task)->level].try_push(task)) {
+					PANIC("Level queue overflow");
+				}
+			}
+
 			struct quantum_level_less {
 				bool operator ()(control_block *lhs, control_block *rhs) const {
 					return get_data(rhs)->quantum_used < get_data(lhs)->quantum_used;
@@ -236,6 +259,7 @@ namespace aikartos::sch {
 			std::uint32_t last_boost_ = 0;
 			control_block *current_ = nullptr;
 			levels_array levels_;
+			std::size_t tasks_count_ = 0;
 			waiting_queue waiting_tasks_;
 			data_object_pool data_pool_;
 		};
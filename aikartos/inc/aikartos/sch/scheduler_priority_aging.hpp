@@ -64,9 +64,17 @@ namespace aikartos::sch {
 				ASSERT(sch_data->current_priority < maximum_priority, "Bad priority value");
 				sch_data->base_priority = sch_data->current_priority;
 				cfg.update_value<config_flags::aging_threshold>(sch_data->aging_threshold);
+
+				// the queues are refilled in PendSV, every one has to hold all the tasks already
+				++tasks_count_;
+				for(auto &queue: ready_tasks_) {
+					const bool reserved = queue.reserve(tasks_count_);
+					ASSERT(reserved, "Not enough memory for the ready queues");
+				}
 			}
 
 			void clear_task(control_block *value) {
+				tasks_count_--;
 				data_allocator_.free(value->template get_scheduler_data<scheduler_data_type>());
 			}
 
@@ -75,7 +83,7 @@ namespace aikartos::sch {
 			void add_task(control_block *value) {
 				const auto priority_id = static_cast<std::size_t>(value->template get_scheduler_data<scheduler_data_type>()->current_priority);
 				DEBUG_ASSERT(priority_id < maximum_priority, "Bad task priority.");
-				ready_tasks_[priority_id].try_push(value);
+				push_ready(priority_id, value);
 			}
 
 			control_block *get_next_task() {
@@ -85,6 +93,15 @@ namespace aikartos::sch {
 				return next_result;
 			}
 
+			std::optional<std::uint32_t> next_wakeup() {
+				return waiting_tasks_.next_wakeup();
+			}
+
+			// 0 is the highest priority
+			bool preempts(control_block *waker, control_block *current) {
+				return get_data(waker)->current_priority < get_data(current)->current_priority;
+			}
+
 		private:
 
 			control_block *get_next_tcb_impl() {
@@ -128,16 +145,23 @@ namespace aikartos::sch {
 						if(++data->aging_score >= data->aging_threshold) {
 							data->aging_score = 0;
 							data->current_priority = priority - 1;
-							ready_tasks_[queue-1].try_push(task);
+							push_ready(queue - 1, task);
 						} else {
-							ready_tasks_[queue].try_push(task);
+							push_ready(queue, task);
 						}
 					}
 				}
 			}
 
 			void add_task_impl(control_block *task, std::uint8_t priority) {
-				ready_tasks_[priority].try_push(task);
+				push_ready(priority, task);
+			}
+
+			// Never allocates, configure_task has reserved the room
+			void push_ready(std::size_t priority, control_block *task) {
+				if(!ready_tasks_[priority].try_push(task)) {
+					PANIC("Ready queue overflow");
+				}
 			}
 
 			auto reset_priority(control_block *task) {
@@ -151,6 +175,7 @@ namespace aikartos::sch {
 			}
 
 			ready_array_type ready_tasks_;
+			std::size_t tasks_count_ = 0;
 			waiting_queue waiting_tasks_;
 			scheduler_data_allocator data_allocator_;
 		};
@@ -19,13 +19,9 @@
 
 #include "aikartos/kernel/core.hpp"
 #include "aikartos/sch/events.hpp"
-#include "aikartos/sch/waiting_tasks_queue.hpp"
-#include "aikartos/sync/circular_queue.hpp"
-#include "aikartos/sync/policies/no_mutex.hpp"
-#include "aikartos/sync/priority_queue.hpp"
 #include "aikartos/tasks/config.hpp"
 #include "aikartos/tasks/object.hpp"
-#include "aikartos/sync/circular_queue.hpp"
+#include "aikartos/utils/intrusive_list.hpp"
 
 namespace aikartos::sch {
 
@@ -43,50 +39,49 @@ namespace aikartos::sch {
 			using control_block  = tasks::control_block;
 			using tasks_events_type = TasksEventsType;
 
-			using task_block_queue_type = sync::circular_queue<control_block *, maximum_tasks, sync::policies::no_mutex>;
-			using waiting_queue = waiting_tasks_queue<maximum_tasks, sync::policies::no_mutex>;
+			using ready_list_type = utils::intrusive_list<control_block, &control_block::ready_node>;
 
 			void configure_task(control_block *, const tasks::config &) {}
-			void clear_task(control_block *) {}
 
+			void clear_task(control_block *value) {
+				ready_list_type::remove(value);
+			}
+
+			// Event-driven (sch::HasOnBlock and the others): the list holds runnable tasks only
 			control_block* get_next_task() {
-				process_waiting_queue();
-
-				while(auto next_task = ready_tasks_.try_pop()) {
-					auto *task = *next_task;
-
-					switch(task->task.state) {
-					case tasks::descriptor::state_type::READY:
-						[[fallthrough]];
-					case tasks::descriptor::state_type::RUNNING:
-						ready_tasks_.try_push(task);
-						return task;
-					case tasks::descriptor::state_type::DONE:
-						tasks_events_type::on_task_done(task);
-						break;
-					case tasks::descriptor::state_type::WAIT:
-						waiting_tasks_.try_push(task);
-						break;
-					default:
-						break;
-					}
+				auto *task = ready_tasks_.front();
+				if(task) {
+					ready_tasks_.move_to_back(task);
 				}
-
-				return nullptr;
+				return task;
 			}
 
 			void add_task(control_block *value) {
-				ready_tasks_.try_push(value);
+				if(!ready_list_type::contains(value)) {
+					ready_tasks_.push_back(value);
+				}
 			}
 
-		private:
+			void on_block(control_block *task) {
+				ready_list_type::remove(task);
+			}
 
-			void process_waiting_queue() {
-				waiting_tasks_.process([this](auto *task){ ready_tasks_.try_push(task); });
+			void on_wake(control_block *task) {
+				add_task(task);
 			}
 
-			task_block_queue_type ready_tasks_;
-			waiting_queue waiting_tasks_;
+			void on_exit(control_block *task) {
+				ready_list_type::remove(task);
+			}
+
+			// The list keeps its order: 'target' runs now and again on its own turn
+			bool handoff(control_block *, control_block *) {
+				return true;
+			}
+
+		private:
+
+			ready_list_type ready_tasks_;
 		};
 
 	}
@@ -19,10 +19,12 @@
 #include "aikartos/rnd/lfsr.hpp"
 #include "aikartos/rnd/xorshift128.hpp"
 #include "aikartos/rnd/xorshift32.hpp"
-#include "aikartos/sch/waiting_tasks_queue.hpp"
-#include "aikartos/sync/policies/no_mutex.hpp"
 #include "aikartos/tasks/config.hpp"
 #include "aikartos/tasks/control_block.hpp"
+#include "aikartos/utils/extent_storage.hpp"
+#include "aikartos/utils/fenwick_tree.hpp"
+#include "aikartos/utils/indexed_heap.hpp"
+#include "aikartos/utils/intrusive_list.hpp"
 #include <limits>
 
 namespace aikartos::sch {
@@ -39,8 +41,15 @@ namespace aikartos::sch {
 			win_agressive 	= (1 << 6),
 		};
 
+		// Event-driven (sch::HasOnBlock and the others): the ready list holds runnable tasks only.
+		// Every task owns a slot of a Fenwick tree with its tickets (0 while it's not ready): the draw is O(log n).
+		// Losers are never visited. A task's tickets are a function of the decisions it has lost since its
+		// anchor (its last win or wake): flat, then growing by lose_delta a decision, then flat at the maximum.
+		// The growing ones sit in the tree as lines over the decision counter, so all of them grow for free,
+		// and a change of the shape is an event in a heap, an O(log n) update when its decision comes
 		template <typename ConfigT, typename TasksEventsType>
 		class scheduler {
+			struct event_less;
 		public:
 			using config = ConfigT;
 
@@ -57,18 +66,26 @@ namespace aikartos::sch {
 			};
 
 			struct scheduler_data_type {
+				// taken at the anchor, see fold
 				std::uint8_t tickets = 1;
 				std::uint8_t base_tickets = 1;
+				std::uint16_t slot = 0;
 
 				adjustment_info win;
 				adjustment_info lose;
+
+				// the decision 'tickets' and 'lose.rounds' are valid at
+				std::uint32_t anchor = 0;
+				// the decision its weight changes the shape at
+				std::uint32_t event = 0;
 			};
 
 			constexpr static std::size_t maximum_tikets_value = std::numeric_limits<decltype(scheduler_data_type::tickets)>::max();
 
 			using scheduler_data_allocator = utils::object_pool<scheduler_data_type, maximum_tasks, 4>;
-			using waiting_queue = waiting_tasks_queue<maximum_tasks, sync::policies::no_mutex>;
-			using ready_array = std::array<control_block *, maximum_tasks>;
+			using ready_list_type = utils::intrusive_list<control_block, &control_block::ready_node>;
+			using events_queue = utils::indexed_heap<control_block, maximum_tasks, event_less, &control_block::heap_index>;
+			using slots_array = utils::extent_storage<control_block *, maximum_tasks>;
 
 			void configure_task(control_block *task, const tasks::config &cfg) {
 				auto *sch_data = data_allocator_.alloc();
@@ -86,80 +103,81 @@ namespace aikartos::sch {
 				cfg.update_value<config_flags::win_delta>(sch_data->win.delta);
 				cfg.update_value<config_flags::win_threshold>(sch_data->win.threshold);
 				cfg.update_value<config_flags::win_agressive>(sch_data->win.agressive);
+
+				// thread mode: the slot tables grow here, never in PendSV
+				std::size_t slot = 0;
+				while(slot < slots_count_ && slots_[slot] != nullptr) {
+					++slot;
+				}
+				if(slot == slots_count_) {
+					const bool reserved = slots_.reserve(slot + 1) && tickets_.reserve(slot + 1) && events_.reserve(slot + 1);
+					ASSERT(reserved, "Not enough memory for the lottery slots");
+					slots_count_++;
+				}
+				slots_[slot] = task;
+				sch_data->slot = static_cast<std::uint16_t>(slot);
 			}
 
 			void clear_task(control_block *task) {
 				remove_task(task);
+				slots_[get_data(task)->slot] = nullptr;
 				data_allocator_.free(get_data(task));
 			}
 
 			control_block* get_next_task() {
-				process_waiting_queue();
-
-				control_block *next_task = nullptr;
-				while(1) {
-					next_task = get_next_task_impl();
-					if(!next_task && (0 == ready_count_)) {
-						break;
-					}
-					if(next_task) {
-						reset_tickets(next_task);
-						adjust_losers(next_task);
-						break;
-					}
+				auto *next_task = get_next_task_impl();
+				if(next_task) {
+					// the others have lost this one: they only have to see the counter move
+					++decisions_;
+					reset_tickets(next_task);
+					process_events();
 				}
 				validate_tickets();
 				return next_task;
 			}
 
 			void add_task(control_block *task) {
-				auto tickets = get_tickets(task);
-				for(std::size_t i = 0; i < ready_.size(); i++) {
-					if(nullptr == ready_[i]) {
-						++ready_count_;
-						total_tickets_ += tickets;
-						ready_[i] = task;
-						break;
-					}
+				if(ready_list_type::contains(task)) {
+					return;
 				}
+				ready_.push_back(task);
+				get_data(task)->anchor = decisions_;
+				place(task);
 				rng_.reset_state(kernel::core::get_systick_val());
 			}
 
+			void on_block(control_block *task) {
+				remove_task(task);
+			}
+
+			void on_wake(control_block *task) {
+				add_task(task);
+			}
+
+			void on_exit(control_block *task) {
+				remove_task(task);
+			}
+
 		private:
 
+			// 'never' for a task that doesn't get the loser bonus from its anchor on
+			constexpr static std::uint32_t never = 0;
+
+			struct event_less {
+				bool operator ()(control_block *lhs, control_block *rhs) const {
+					return static_cast<std::int32_t>(get_data(lhs)->event - get_data(rhs)->event) < 0;
+				}
+			};
+
 			control_block *get_next_task_impl() {
-				if(total_tickets_ > 0) {
-					const auto next_win = (rng_.next() % total_tickets_);
-					std::uint32_t current_tickets = 0;
-					std::size_t task_checked = 0;
-					for(std::size_t i = 0; (i < ready_.size()) && (task_checked < ready_count_); i++) {
-						if(nullptr != ready_[i]) {
-							auto *task = ready_[i];
-							const auto tickets = get_tickets(task);
-							switch(task->task.state) {
-							case tasks::descriptor::state_type::READY:
-								[[fallthrough]];
-							case tasks::descriptor::state_type::RUNNING:
-								current_tickets += tickets;
-								if(next_win < current_tickets) {
-									decay_winner(task);
-									return task;
-								}
-								break;
-							case tasks::descriptor::state_type::DONE:
-								tasks_events_type::on_task_done(task);
-								break;
-							case tasks::descriptor::state_type::WAIT:
-								remove_task(task);
-								waiting_tasks_.try_push(task);
-								break;
-							default:
-								break;
-							}
-						}
-					}
+				const auto total_tickets = tickets_.total(decisions_);
+				if(total_tickets == 0) {
+					return nullptr;
 				}
-				return nullptr;
+				auto *task = slots_[tickets_.find(rng_.next_below(total_tickets), decisions_)];
+				fold(task);
+				decay_winner(task);
+				return task;
 			}
 
 			void decay_winner(control_block *winner) {
@@ -167,16 +185,13 @@ namespace aikartos::sch {
 				const auto win_rounds = ++data->win.rounds;
 				if(data->lose.rounds > 0) {
 					data->lose.rounds = 0;
-					total_tickets_ -= (data->tickets - data->base_tickets);
 					data->tickets = data->base_tickets;
 				}
 				if(win_rounds >= data->win.threshold) {
 					if(data->tickets > data->win.delta) {
-						total_tickets_-= data->win.delta;
 						data->tickets -= data->win.delta;
 					}
 					else {
-						total_tickets_ -= (data->tickets - 1);
 						data->tickets = 1;
 					}
 					if(!data->win.agressive) {
@@ -185,59 +200,115 @@ namespace aikartos::sch {
 				}
 			}
 
-			void adjust_losers(control_block *winner) {
-				for(std::size_t i = 0; i < ready_.size(); i++) {
-					auto *current_task = ready_[i];
-					if(current_task && (current_task != winner)) {
-						auto *data = get_data(current_task);
-						const auto current_tickts = data->tickets;
-						const auto threshold = data->lose.threshold;
-
-						if(data->win.rounds > 0) {
-							data->win.rounds = 0;
-							total_tickets_ += (data->base_tickets - data->tickets);
-							data->tickets = data->base_tickets;
-						}
-
-						++data->lose.rounds;
-						if(data->lose.rounds >= threshold) {
-							if((current_tickts + data->lose.delta) <= maximum_tikets_value) {
-								total_tickets_ += data->lose.delta;
-								data->tickets += data->lose.delta;
-							} else {
-								const auto delta = maximum_tikets_value - current_tickts;
-								total_tickets_ += delta;
-								data->tickets = maximum_tikets_value;
-							}
-						}
-						if(!data->lose.agressive) {
-							data->lose.rounds = 0;
-						}
-					}
+			// The loss (1-based, since the anchor) that gives the first bonus, 'never' if none does
+			static std::uint32_t first_bonus(const scheduler_data_type *data) {
+				if((data->lose.delta == 0) || (data->tickets >= maximum_tikets_value)) {
+					return never;
+				}
+				if(!data->lose.agressive) {
+					// the rounds go back to 0 after every loss, so it's every one or none
+					return (data->lose.threshold <= 1) ? 1 : never;
 				}
+				const auto rounds = data->lose.rounds;
+				return (rounds + 1 >= data->lose.threshold) ? 1 : (data->lose.threshold - rounds);
 			}
 
-			void remove_task(control_block *task) {
-				auto tickets = get_tickets(task);
-				for(std::size_t i = 0; i < ready_.size(); i++) {
-					if(task == ready_[i]) {
-						--ready_count_;
-						total_tickets_ -= tickets;
-						ready_[i] = nullptr;
+			// The tickets after 'losses' decisions lost since the anchor
+			static std::uint32_t tickets_after(const scheduler_data_type *data, std::uint32_t losses) {
+				const auto first = first_bonus(data);
+				if((first == never) || (losses < first)) {
+					return data->tickets;
+				}
+				const auto bonuses = losses - first + 1;
+				const auto room = static_cast<std::uint32_t>(maximum_tikets_value - data->tickets);
+				// no overflow: the bonuses only count until the room is gone
+				if((bonuses >= room) || (bonuses * data->lose.delta >= room)) {
+					return maximum_tikets_value;
+				}
+				return data->tickets + bonuses * data->lose.delta;
+			}
+
+			// What adjust_losers did for every loss, in one step: the state moves to the current decision
+			void fold(control_block *task) {
+				auto *data = get_data(task);
+				const auto losses = decisions_ - data->anchor;
+				if(losses > 0) {
+					data->tickets = static_cast<std::uint8_t>(tickets_after(data, losses));
+					data->lose.rounds = data->lose.agressive ? (data->lose.rounds + losses) : 0;
+					data->win.rounds = 0;
+					data->anchor = decisions_;
+				}
+			}
+
+			// The task's weight from the current decision on, and the decision that changes it next
+			void place(control_block *task) {
+				auto *data = get_data(task);
+				const auto first = first_bonus(data);
+				const auto losses = decisions_ - data->anchor;
+				if(first == never) {
+					set_weight(task, data->tickets, 0);
+				}
+				else if(losses + 1 < first) {
+					// the decision at which the last loss without a bonus is counted
+					set_weight(task, data->tickets, 0, data->anchor + first - 1);
+				}
+				else if(const auto tickets = tickets_after(data, losses); tickets >= maximum_tikets_value) {
+					set_weight(task, maximum_tikets_value, 0);
+				}
+				else {
+					// 'tickets' now, plus 'delta' a decision: the line through (start, data->tickets)
+					const std::uint32_t delta = data->lose.delta;
+					const auto start = data->anchor + first - 1;
+					const auto room = static_cast<std::uint32_t>(maximum_tikets_value - data->tickets);
+					set_weight(task, data->tickets - delta * start, delta, start + (room + delta - 1) / delta);
+				}
+			}
+
+			void set_weight(control_block *task, std::uint32_t base, std::uint32_t slope) {
+				tickets_.set(get_data(task)->slot, base, slope);
+				events_.erase(task);
+			}
+
+			void set_weight(control_block *task, std::uint32_t base, std::uint32_t slope, std::uint32_t event) {
+				tickets_.set(get_data(task)->slot, base, slope);
+				get_data(task)->event = event;
+				if(events_.contains(task)) {
+					events_.update(task);
+				}
+				else {
+					// never allocates, configure_task has reserved a place for every task
+					events_.push(task);
+				}
+			}
+
+			// Only the tasks whose shape changes at this decision, O(log n) each
+			void process_events() {
+				while(auto *task = events_.top()) {
+					if(static_cast<std::int32_t>(decisions_ - get_data(task)->event) < 0) {
 						break;
 					}
+					place(task);
+				}
+			}
+
+			void remove_task(control_block *task) {
+				if(ready_list_type::remove(task)) {
+					fold(task);
+					tickets_.set(get_data(task)->slot, 0, 0);
+					events_.erase(task);
 				}
 			}
 
 			inline void validate_tickets() {
 #ifdef DEBUG
 				std::size_t tickets = 0;
-				for(std::size_t i = 0; i < ready_.size(); i++) {
-					if(nullptr != ready_[i]) {
-						tickets += get_tickets(ready_[i]);
-					}
-				}
-				ASSERT(total_tickets_ == tickets, "Something went wrong!");
+				ready_.foreach([&](control_block *task) {
+					auto *data = get_data(task);
+					const auto current = tickets_after(data, decisions_ - data->anchor);
+					ASSERT(tickets_.get(data->slot, decisions_) == current, "Bad ticket line");
+					tickets += current;
+				});
+				ASSERT(tickets_.total(decisions_) == tickets, "Something went wrong!");
 #endif
 			}
 
@@ -245,33 +316,24 @@ namespace aikartos::sch {
 				return task->template get_scheduler_data<scheduler_data_type>();
 			}
 
+			// The winner starts over: base tickets, anchored at this decision
 			void reset_tickets(control_block *task) {
 				auto *data = get_data(task);
-				if(data->tickets > data->base_tickets) {
-					total_tickets_ -= (data->tickets - data->base_tickets);
-				} else {
-					total_tickets_ += (data->base_tickets - data->tickets);
-				}
 				data->tickets = data->base_tickets;
-			}
-
-			static std::uint8_t get_tickets(control_block *task) {
-				return get_data(task)->tickets;
-			}
-
-			static std::uint8_t get_base_tickets(control_block *task) {
-				return get_data(task)->base_tickets;
-			}
-
-			void process_waiting_queue() {
-				waiting_tasks_.process([this](auto *task){ add_task(task); });
+				data->anchor = decisions_;
+				place(task);
 			}
 
 			rnd::xorshift32 rng_;
-			std::size_t ready_count_ = 0;
-			std::uint32_t total_tickets_ = 0;
-			waiting_queue waiting_tasks_;
-			ready_array ready_ {};
+			ready_list_type ready_;
+			// by slot: the task and its tickets while it's ready, as lines over decisions_
+			slots_array slots_ {};
+			utils::linear_fenwick_tree<maximum_tasks> tickets_;
+			// the ready tasks whose tickets will change the shape
+			events_queue events_;
+			// the count of the decisions made, it wraps
+			std::uint32_t decisions_ = 0;
+			std::size_t slots_count_ = 0;
 			scheduler_data_allocator data_allocator_;
 		};
 	}
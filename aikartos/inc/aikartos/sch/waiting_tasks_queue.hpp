@@ -7,13 +7,16 @@
 
 #pragma once
 
-#include "aikartos/kernel/core.hpp"
+#include <optional>
+
+#include "aikartos/kernel/sleep_queue.hpp"
 #include "aikartos/sync/policies/mutex_policy.hpp"
-#include "aikartos/sync/priority_queue.hpp"
 #include "aikartos/tasks/control_block.hpp"
 
 namespace aikartos::sch {
 
+	// Scheduler side of kernel::sleep_queue. All the instances share the kernel timing wheel,
+	// so the parameters are kept for the existing schedulers only.
 	template <std::size_t MaximumTasks, sync::policies::MutexPolicy MutexT>
 	class waiting_tasks_queue {
 	public:
@@ -22,40 +25,24 @@ namespace aikartos::sch {
 		using control_block = tasks::control_block;
 		using mutex_type = MutexT;
 
-		struct wait_less_time {
-			bool operator ()(control_block *lhs, control_block *rhs) const {
-				return rhs->task.timing.next_run < lhs->task.timing.next_run;
-			}
-		};
-		using wating_tasks_queue_type = sync::priority_queue<control_block *, maximum_tasks, wait_less_time, mutex_type>;
-
 		inline void try_push(control_block *task) {
-			queue_.try_push(task);
+			kernel::sleep_queue::push(task);
 		}
 
 		template <typename CallBackT>
 		void foreach(CallBackT cb) {
-			queue_.foreach(std::move(cb));
+			kernel::sleep_queue::foreach(std::move(cb));
+		}
+
+		// the tick at which the earliest sleeper has to be woken up
+		inline std::optional<std::uint32_t> next_wakeup() {
+			return kernel::sleep_queue::next_wakeup();
 		}
 
+		// O(1) if nobody is due: SysTick has already done the sorting
 		template <typename CallBackT>
 		inline void process(CallBackT cb) {
-			auto const ticks = kernel::core::get_tick_count();
-			while(auto next = queue_.peek()) {
-				auto *task = next.value();
-				if(task->task.timing.next_run <= ticks) {
-					queue_.try_pop();
-					task->task.state = tasks::descriptor::state_type::READY;
-					cb(task);
-				}
-				else {
-					break;
-				}
-			}
+			kernel::sleep_queue::process(std::move(cb));
 		}
-
-	private:
-		wating_tasks_queue_type queue_;
 	};
-
 }
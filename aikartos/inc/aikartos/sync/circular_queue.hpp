@@ -23,14 +23,21 @@ namespace aikartos::sync {
 	public:
 		using mutex_type = MutexType;
 		using element_type = T;
-		constexpr static std::size_t queue_size = QueueSize + 1;
-		using contailer_type = utils::circular_deque<element_type, queue_size + 1>;
+		constexpr static bool is_dynamic = (QueueSize == utils::dynamic_extent);
+		constexpr static std::size_t queue_size = is_dynamic ? utils::dynamic_extent : QueueSize + 1;
+		using contailer_type = utils::circular_deque<element_type, is_dynamic ? utils::dynamic_extent : queue_size + 1>;
 
 		bool try_push(element_type value) {
 			sync::lock_guard<mutex_type> l(lock_);
 			return queue_.emplace_back(std::move(value));
 		}
 
+		// Room for 'count' elements: the following pushes don't allocate (utils::dynamic_extent)
+		bool reserve(std::size_t count) {
+			sync::lock_guard<mutex_type> l(lock_);
+			return queue_.reserve(count);
+		}
+
 		std::optional<element_type> try_get(std::size_t id) const {
 			sync::lock_guard<mutex_type> l(lock_);
 			if(id < size()) {
@@ -10,12 +10,19 @@
 #include "aikartos/device/device.hpp"
 
 namespace aikartos::sync {
+	// Nestable: restores the PRIMASK it found, so it's safe inside handlers that already masked IRQs
 	struct irq_critical_section {
-		irq_critical_section() {
+		irq_critical_section()
+			: primask_(__get_PRIMASK())
+		{
 			__disable_irq();
 		}
 		~irq_critical_section() {
-			__enable_irq();
+			__set_PRIMASK(primask_);
 		}
+		irq_critical_section(const irq_critical_section &) = delete;
+		irq_critical_section &operator = (const irq_critical_section &) = delete;
+	private:
+		const std::uint32_t primask_;
 	};
 }
@@ -0,0 +1,31 @@
+/*
+ * kernel_critical_section.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include "aikartos/const/constants.hpp"
+#include "aikartos/device/device.hpp"
+
+namespace aikartos::sync {
+	// Masks the interrupts at and below the kernel ceiling (BASEPRI, constants::kernel_irq_ceiling).
+	// The more urgent ones keep running, so they must not touch the kernel state.
+	// Nestable: only raises BASEPRI and restores the value it found
+	struct kernel_critical_section {
+		kernel_critical_section()
+			: basepri_(__get_BASEPRI())
+		{
+			__set_BASEPRI_MAX(constants::kernel_basepri);
+		}
+		~kernel_critical_section() {
+			__set_BASEPRI(basepri_);
+		}
+		kernel_critical_section(const kernel_critical_section &) = delete;
+		kernel_critical_section &operator = (const kernel_critical_section &) = delete;
+	private:
+		const std::uint32_t basepri_;
+	};
+}
@@ -0,0 +1,93 @@
+/*
+ * mpsc_queue.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace aikartos::sync {
+
+	// Bounded lock-free queue (D. Vyukov): any number of producers, one consumer.
+	// Every cell carries a sequence number, so producers only race on one CAS of the enqueue position.
+	// Producers may be interrupts of any priority: nothing ever waits for a preempted producer,
+	// the consumer just sees the queue as empty until that cell is published.
+	template <typename T, std::size_t Capacity>
+	class mpsc_queue {
+	public:
+		static_assert((Capacity >= 2) && ((Capacity & (Capacity - 1)) == 0), "Capacity has to be a power of two");
+
+		using element_type = T;
+		constexpr static std::size_t capacity = Capacity;
+
+		mpsc_queue() {
+			for(std::size_t i = 0; i < capacity; ++i) {
+				cells_[i].sequence.store(static_cast<std::uint32_t>(i), std::memory_order_relaxed);
+			}
+		}
+
+		mpsc_queue(const mpsc_queue &) = delete;
+		mpsc_queue &operator = (const mpsc_queue &) = delete;
+
+		// false if the queue is full
+		bool try_push(element_type value) {
+			auto position = enqueue_position_.load(std::memory_order_relaxed);
+			while(true) {
+				auto &cell = cells_[position & mask];
+				const auto sequence = cell.sequence.load(std::memory_order_acquire);
+				const auto diff = static_cast<std::int32_t>(sequence - position);
+				if(diff == 0) {
+					if(enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						cell.data = std::move(value);
+						cell.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if(diff < 0) {
+					return false;
+				}
+				else {
+					position = enqueue_position_.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// The consumer side
+		std::optional<element_type> try_pop() {
+			auto &cell = cells_[dequeue_position_ & mask];
+			const auto sequence = cell.sequence.load(std::memory_order_acquire);
+			if(static_cast<std::int32_t>(sequence - (dequeue_position_ + 1)) < 0) {
+				return {};
+			}
+			std::optional<element_type> result { std::move(cell.data) };
+			cell.sequence.store(dequeue_position_ + capacity, std::memory_order_release);
+			dequeue_position_ += 1;
+			return result;
+		}
+
+		// The consumer side. A cell that is claimed but not published yet counts as empty
+		bool empty() const {
+			const auto &cell = cells_[dequeue_position_ & mask];
+			return static_cast<std::int32_t>(cell.sequence.load(std::memory_order_acquire) - (dequeue_position_ + 1)) < 0;
+		}
+
+	private:
+
+		constexpr static std::uint32_t mask = capacity - 1;
+
+		struct cell_type {
+			std::atomic<std::uint32_t> sequence;
+			element_type data;
+		};
+
+		cell_type cells_[capacity];
+		std::atomic<std::uint32_t> enqueue_position_ = 0;
+		std::uint32_t dequeue_position_ = 0;
+	};
+}
@@ -16,6 +16,7 @@
 #include "aikartos/sync/lock_guarg.hpp"
 #include "aikartos/sync/policies/mutex_policy.hpp"
 #include "aikartos/sync/spin_lock.hpp"
+#include "aikartos/utils/extent_storage.hpp"
 
 namespace aikartos::sync {
 
@@ -33,14 +34,20 @@ namespace aikartos::sync {
 
 		bool try_push(element_type value) {
 			sync::lock_guard<mutex_type> l(lock_);
-			if (count_ == queue_size) {
+			if (!items_.reserve(count_ + 1)) {
 				return false;
 			}
 			items_[count_++] = std::move(value);
-			std::push_heap(items_.begin(), std::next(items_.begin(), count_), less_type{});
+			std::push_heap(items_.data(), items_.data() + count_, less_type{});
 			return true;
 		}
 
+		// Room for 'count' elements: the following pushes don't allocate (utils::dynamic_extent)
+		bool reserve(std::size_t count) {
+			sync::lock_guard<mutex_type> l(lock_);
+			return items_.reserve(count);
+		}
+
 		std::optional<element_type> peek() {
 			sync::lock_guard<mutex_type> l(lock_);
 			if (count_ == 0) {
@@ -55,7 +62,7 @@ namespace aikartos::sync {
 				return {};
 			}
 
-			std::pop_heap(items_.begin(), std::next(items_.begin(), count_), less_type{});
+			std::pop_heap(items_.data(), items_.data() + count_, less_type{});
 			element_type value = std::move(items_[--count_]);
 			return { value };
 		}
@@ -68,7 +75,7 @@ namespace aikartos::sync {
 		}
 
 	private:
-		std::array<element_type, queue_size> items_;
+		utils::extent_storage<element_type, queue_size> items_;
 		std::size_t count_ = 0;
 		mutex_type lock_;
 	};
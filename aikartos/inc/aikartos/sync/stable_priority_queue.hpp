@@ -14,8 +14,10 @@
 #include <concepts>
 #include <functional>
 
+#include "aikartos/sync/lock_guarg.hpp"
 #include "aikartos/sync/policies/mutex_policy.hpp"
 #include "aikartos/sync/spin_lock.hpp"
+#include "aikartos/utils/extent_storage.hpp"
 
 namespace aikartos::sync {
 	template <typename T,
@@ -31,11 +33,11 @@ namespace aikartos::sync {
 
 		bool try_push(element_type value) {
 			sync::lock_guard<mutex_type> l(lock_);
-			if (count_ == queue_size) {
+			if (!items_.reserve(count_ + 1)) {
 				return false;
 			}
 			items_[count_++] = queue_element{ .value = std::move(value), .enqueue_order = index_++ };
-			std::push_heap(items_.begin(), std::next(items_.begin(), count_), less_wrapper{});
+			std::push_heap(items_.data(), items_.data() + count_, less_wrapper{});
 			return true;
 		}
 
@@ -52,7 +54,7 @@ namespace aikartos::sync {
 			if (count_ == 0) {
 				return {};
 			}
-			std::pop_heap(items_.begin(), std::next(items_.begin(), count_), less_wrapper{});
+			std::pop_heap(items_.data(), items_.data() + count_, less_wrapper{});
 			auto [value, index] = std::move(items_[--count_]);
 			if (0 == count_) {
 				index_ = 0;
@@ -87,7 +89,7 @@ namespace aikartos::sync {
 			}
 		};
 
-		std::array<queue_element, queue_size> items_;
+		utils::extent_storage<queue_element, queue_size> items_;
 		std::size_t count_ = 0;
 		std::size_t index_ = 0;
 		mutex_type lock_;
@@ -9,6 +9,7 @@
 
 #include "aikartos/sync/circular_queue.hpp"
 #include "aikartos/sync/irq_critical_section.hpp"
+#include "aikartos/sync/kernel_critical_section.hpp"
 #include "aikartos/sync/policies/mutex_policy.hpp"
 #include "aikartos/sync/policies/no_mutex.hpp"
 #include "aikartos/sync/policies/no_yield.hpp"
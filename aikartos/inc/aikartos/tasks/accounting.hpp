@@ -0,0 +1,39 @@
+/*
+ * accounting.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace aikartos::tasks {
+
+	// Per-task runtime counters, updated by the kernel on every real context switch.
+	// Time values are DWT->CYCCNT core clock cycles.
+	struct accounting {
+		std::uint64_t cycles = 0;		// total time on the CPU
+		std::uint32_t dispatches = 0;	// how many times the task was switched in
+		std::uint32_t yields = 0;		// switched out voluntarily (yield, sleep, termination)
+		std::uint32_t preemptions = 0;	// switched out by the kernel (quanta, wakeups, interrupts)
+		std::uint32_t last_run = 0;		// timestamp of the last switch out
+		std::uint32_t switched_in = 0;	// timestamp of the last switch in
+	};
+
+	// Fields of kernel::core::get_tasks_statistic
+	enum class accounting_fields : std::uint32_t {
+		task_entry = 0u,
+		task_param = 1u,
+		state = 2u,
+		cycles_low = 3u,
+		cycles_high = 4u,
+		dispatches = 5u,
+		yields = 6u,
+		preemptions = 7u,
+		last_run = 8u,
+		stack_unused = 9u,	// words, control_block::stack_unused_words
+		overruns = 10u,		// descriptor::timing_info::overruns
+	};
+}
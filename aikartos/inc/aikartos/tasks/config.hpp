@@ -15,4 +15,10 @@ namespace aikartos::tasks {
 
 	using config = utils::flagged_storage<16>;
 
+	// Kernel level flags take the upper bits, the lower ones belong to the schedulers
+	enum class config_flags : std::uint32_t {
+		stack_size = (1u << 15u),	// stack size in words; such a task is allocated from the heap
+		period = (1u << 14u),		// release period in ms, see this_task::wait_next_period
+	};
+
 }
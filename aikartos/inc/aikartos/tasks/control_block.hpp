@@ -8,7 +8,11 @@
 #pragma once
 
 #include "aikartos/platform/platform.hpp"
+#include "aikartos/tasks/accounting.hpp"
 #include "aikartos/tasks/descriptor.hpp"
+#include "aikartos/utils/align_up.hpp"
+#include "aikartos/utils/intrusive_list.hpp"
+#include "aikartos/utils/timing_wheel.hpp"
 #include <cstdint>
 
 namespace aikartos::tasks {
@@ -16,10 +20,16 @@ namespace aikartos::tasks {
 	enum class task_flags: std::uint32_t {
 #if defined(PLATFORM_USE_FPU)
 		use_fpu = (1u << 0),
-		fpu_saved = (1u << 1),
+		fpu_saved = (1u << 1), // the saved context has an extended frame and s16-s31
 #endif
 	};
 
+	// Every stack is filled with it at creation, see control_block::stack_unused_words
+	constexpr std::uint32_t stack_paint_value = 0xDEADBEEF;
+
+	// KERNEL_USE_STACK_GUARD: the first 32-byte aligned block of every stack is an MPU no-access region
+	constexpr std::size_t stack_guard_size = 32;
+
 	struct alignas(8) control_block {
 
 		std::uintptr_t stack = 0;
@@ -42,6 +52,43 @@ namespace aikartos::tasks {
 
 		tasks::descriptor task;
 		void *scheduler_data = nullptr;
+		tasks::accounting accounting;
+
+		// Links the task into the kernel timing wheel while it sleeps (kernel::sleep_queue)
+		utils::timing_node wait_node;
+
+		// Links the task into its scheduler's ready list (utils::intrusive_list), O(1) unlink from anywhere
+		utils::list_node ready_node;
+		// Its position in the scheduler's utils::indexed_heap
+		std::uint32_t heap_index = 0xFFFF'FFFF;
+
+		// The lowest address of the stack and its size
+		std::uintptr_t stack_base = 0;
+		std::uint32_t stack_words = 0;
+
+		inline std::uintptr_t stack_guard_address() const {
+			return utils::align_up(stack_base, stack_guard_size);
+		}
+
+		// The lowest address the task can touch
+		inline std::uintptr_t stack_usable_base() const {
+#if defined(KERNEL_USE_STACK_GUARD)
+			return stack_guard_address() + stack_guard_size;
+#else
+			return stack_base;
+#endif
+		}
+
+		// High-water mark: the words at the bottom of the stack that still hold the paint
+		std::size_t stack_unused_words() const {
+			auto *word = reinterpret_cast<const std::uint32_t *>(stack_usable_base());
+			auto *top = reinterpret_cast<const std::uint32_t *>(stack_base) + stack_words;
+			std::size_t count = 0;
+			while((word + count < top) && (word[count] == stack_paint_value)) {
+				++count;
+			}
+			return count;
+		}
 
 		template <typename T>
 		T *get_scheduler_data() {
@@ -20,7 +20,8 @@ namespace aikartos::tasks {
 		};
 		struct timing_info {
 			std::uint32_t period_ms = 0;
-			std::uint32_t next_run = 0;
+			std::uint32_t next_run = 0;	// the wakeup tick, for periodic tasks the last release
+			std::uint32_t overruns = 0;	// periodic releases that started late
 		};
 
 		using task_parameter = void *;
@@ -7,7 +7,12 @@
 
 #pragma once
 
+#include <cstdlib>
+#include <new>
+
 #include "aikartos/tasks/control_block.hpp"
+#include "aikartos/utils/align_up.hpp"
+#include "aikartos/utils/intrusive_list.hpp"
 
 namespace aikartos::tasks {
 
@@ -20,11 +25,11 @@ namespace aikartos::tasks {
 
 		constexpr void reset_stack() {
 			tcb.stack = reinterpret_cast<std::uintptr_t>(&stack[StackSize]);
-#ifdef DEBUG
+			tcb.stack_base = reinterpret_cast<std::uintptr_t>(&stack[0]);
+			tcb.stack_words = StackSize;
 		    for (std::size_t i = 0; i < StackSize; ++i) {
-		        stack[i] = 0xDEADBEEF;
+		        stack[i] = stack_paint_value;
 		    }
-#endif
 		}
 
 		object() {
@@ -34,5 +39,46 @@ namespace aikartos::tasks {
 		control_block tcb;
 		alignas(8) word_type stack[StackSize];
 	};
-}
 
+	// A task with the stack size chosen at runtime (tasks::config_flags::stack_size).
+	// The control block and the stack share one heap block: [heap_object][stack]
+	struct alignas(8) heap_object {
+
+		using word_type = std::uint32_t;
+		constexpr static std::size_t minimum_stack_size = 32;
+
+		static heap_object *create(std::size_t stack_words) {
+			if(stack_words < minimum_stack_size) {
+				stack_words = minimum_stack_size;
+			}
+			stack_words = utils::align_up(stack_words, 2); // keeps the stack top 8-byte aligned
+			auto *memory = std::malloc(sizeof(heap_object) + stack_words * sizeof(word_type) + alignof(heap_object) - 1);
+			if(memory == nullptr) {
+				return nullptr;
+			}
+			auto address = utils::align_up(reinterpret_cast<std::uintptr_t>(memory), alignof(heap_object));
+			auto *object = new (reinterpret_cast<void *>(address)) heap_object;
+			object->memory = memory;
+
+			auto *stack = reinterpret_cast<word_type *>(object + 1);
+			object->tcb.stack_base = reinterpret_cast<std::uintptr_t>(stack);
+			object->tcb.stack_words = stack_words;
+			object->tcb.stack = reinterpret_cast<std::uintptr_t>(stack + stack_words);
+		    for (std::size_t i = 0; i < stack_words; ++i) {
+		        stack[i] = stack_paint_value;
+		    }
+			return object;
+		}
+
+		static void destroy(heap_object *object) {
+			auto *memory = object->memory;
+			object->~heap_object();
+			std::free(memory);
+		}
+
+		control_block tcb;
+		void *memory = nullptr;
+		// The kernel's list of the heap tasks, for the statistics walk
+		utils::list_node all_node;
+	};
+}
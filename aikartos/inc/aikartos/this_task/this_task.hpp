@@ -25,6 +25,26 @@ namespace aikartos::this_task {
 		return kernel::api::sleep(millieconds);
 	}
 
+	// Absolute tick, see kernel::get_tick_count
+	inline void sleep_until(std::uint32_t tick) {
+		return kernel::api::sleep_until(tick);
+	}
+
+	// Periodic tasks only (tasks::config_flags::period)
+	inline void wait_next_period() {
+		return kernel::api::wait_next_period();
+	}
+
+	// Releases of this periodic task that started late
+	inline std::uint32_t get_overruns() {
+		return kernel::api::get_current_tcb()->task.timing.overruns;
+	}
+
+	// Words of the stack this task has never touched so far
+	inline std::size_t stack_unused_words() {
+		return kernel::api::get_current_tcb()->stack_unused_words();
+	}
+
 	inline void sleep_for(std::uint32_t millieconds) {
 		auto *task = kernel::api::get_current_tcb();
 		DEBUG_ASSERT(current_tcb != nullptr, "Bad current task...");
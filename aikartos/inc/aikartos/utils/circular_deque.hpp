@@ -10,8 +10,11 @@
 
 #include <cstdint>
 #include <new>
+#include <optional>
 #include <tuple>
 
+#include "aikartos/utils/extent_storage.hpp"
+
 namespace aikartos::utils {
 
 	template<typename T, std::size_t QueueSize, std::size_t Align = alignof(T)>
@@ -131,6 +134,11 @@ namespace aikartos::utils {
 			return ((tail_ + 1) % queue_size) == head_;
 		}
 
+		// true if 'count' elements fit
+		constexpr bool reserve(std::size_t count) const {
+			return count < queue_size;
+		}
+
 		void clear() {
 			while (!empty()) {
 				std::ignore = pop_front();
@@ -149,4 +157,112 @@ namespace aikartos::utils {
 		std::size_t head_ = 0;
 		std::size_t tail_ = 0;
 	};
+
+	// Grows on demand from the heap. Elements are relocated with a plain copy
+	template<typename T, std::size_t Align>
+	class circular_deque<T, dynamic_extent, Align> {
+	public:
+
+		using element_type = T;
+		constexpr static std::size_t queue_size = dynamic_extent;
+
+		circular_deque() = default;
+		circular_deque(const circular_deque&) = delete;
+		circular_deque& operator=(const circular_deque&) = delete;
+
+		bool push_back(const element_type &value) {
+			return emplace_back(value);
+		}
+
+		template<typename ... Args>
+		bool emplace_back(Args &&... args) {
+			if (!grow()) {
+				return false;
+			}
+			items_[index(count_)] = element_type(std::forward<Args>(args)...);
+			count_++;
+			return true;
+		}
+
+		bool push_front(const element_type &value) {
+			return emplace_front(value);
+		}
+
+		template<typename ... Args>
+		bool emplace_front(Args &&... args) {
+			if (!grow()) {
+				return false;
+			}
+			head_ = (head_ + items_.size() - 1) % items_.size();
+			items_[head_] = element_type(std::forward<Args>(args)...);
+			count_++;
+			return true;
+		}
+
+		std::optional<element_type> pop_front() {
+			if (empty()) {
+				return std::nullopt;
+			}
+			element_type value = items_[head_];
+			head_ = (head_ + 1) % items_.size();
+			count_--;
+			return { value };
+		}
+
+		std::optional<element_type> pop_back() {
+			if (empty()) {
+				return std::nullopt;
+			}
+			count_--;
+			return { items_[index(count_)] };
+		}
+
+		element_type& front() { return items_[head_]; }
+		const element_type& front() const { return items_[head_]; }
+		element_type& back() { return items_[index(count_ - 1)]; }
+		const element_type& back() const { return items_[index(count_ - 1)]; }
+		element_type& operator[](std::size_t id) { return items_[index(id)]; }
+		const element_type& operator[](std::size_t id) const { return items_[index(id)]; }
+
+		std::size_t size() const { return count_; }
+		bool empty() const { return count_ == 0; }
+		bool full() const { return false; }
+
+		// Makes room for 'count' elements, so the following pushes never allocate.
+		// false if the heap is exhausted
+		bool reserve(std::size_t count) {
+			const auto old_size = items_.size();
+			if (count <= old_size) {
+				return true;
+			}
+			if (!items_.reserve(count)) {
+				return false;
+			}
+			// the storage at least doubles, so the wrapped part fits right after the old end
+			for (std::size_t i = 0; i < head_; ++i) {
+				items_[old_size + i] = items_[i];
+			}
+			return true;
+		}
+
+		void clear() {
+			head_ = 0;
+			count_ = 0;
+		}
+
+	private:
+
+		std::size_t index(std::size_t id) const {
+			return (head_ + id) % items_.size();
+		}
+
+		// Makes room for one more element, unrolling the ring if it had wrapped
+		bool grow() {
+			return reserve(count_ + 1);
+		}
+
+		extent_storage<element_type, dynamic_extent> items_;
+		std::size_t head_ = 0;
+		std::size_t count_ = 0;
+	};
 }
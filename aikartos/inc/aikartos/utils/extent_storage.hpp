@@ -0,0 +1,99 @@
+/*
+ * extent_storage.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+namespace aikartos::utils {
+
+	// Capacity that is not known at compile time: the container grows on demand from the heap.
+	// Fits the 32-bit config fields, i.e. kernel::config::maximum_tasks = utils::dynamic_extent
+	constexpr std::size_t dynamic_extent = std::numeric_limits<std::uint32_t>::max();
+
+	// Element storage of the fixed size containers.
+	// Extent == dynamic_extent makes it a heap array that only grows.
+	template <typename T, std::size_t Extent>
+	class extent_storage {
+	public:
+		using element_type = T;
+		constexpr static bool is_dynamic = false;
+
+		// true if 'count' elements fit
+		constexpr bool reserve(std::size_t count) const {
+			return count <= Extent;
+		}
+
+		constexpr std::size_t size() const { return Extent; }
+		element_type *data() { return items_.data(); }
+		const element_type *data() const { return items_.data(); }
+		element_type &operator[](std::size_t id) { return items_[id]; }
+		const element_type &operator[](std::size_t id) const { return items_[id]; }
+
+	private:
+		std::array<element_type, Extent> items_ = {};
+	};
+
+	template <typename T>
+	class extent_storage<T, dynamic_extent> {
+	public:
+		using element_type = T;
+		constexpr static bool is_dynamic = true;
+		constexpr static std::size_t initial_size = 4;
+
+		static_assert(std::is_trivially_copyable_v<T> && std::default_initializable<T>,
+				"The dynamic storage relocates elements with a plain copy");
+
+		extent_storage() = default;
+		extent_storage(const extent_storage &) = delete;
+		extent_storage &operator = (const extent_storage &) = delete;
+
+		~extent_storage() {
+			std::free(items_);
+		}
+
+		// Grows (at least twice) to fit 'count' elements, new elements are value-initialized.
+		// false if the heap is exhausted; the old elements stay untouched
+		bool reserve(std::size_t count) {
+			if(count <= size_) {
+				return true;
+			}
+			std::size_t new_size = size_ ? size_ * 2 : initial_size;
+			new_size = (new_size < count) ? count : new_size;
+			auto *items = static_cast<element_type *>(std::malloc(new_size * sizeof(element_type)));
+			if(items == nullptr) {
+				return false;
+			}
+			for(std::size_t i = 0; i < size_; ++i) {
+				new (&items[i]) element_type(items_[i]);
+			}
+			for(std::size_t i = size_; i < new_size; ++i) {
+				new (&items[i]) element_type{};
+			}
+			std::free(items_);
+			items_ = items;
+			size_ = new_size;
+			return true;
+		}
+
+		std::size_t size() const { return size_; }
+		element_type *data() { return items_; }
+		const element_type *data() const { return items_; }
+		element_type &operator[](std::size_t id) { return items_[id]; }
+		const element_type &operator[](std::size_t id) const { return items_[id]; }
+
+	private:
+		element_type *items_ = nullptr;
+		std::size_t size_ = 0;
+	};
+}
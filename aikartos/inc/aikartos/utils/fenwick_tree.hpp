@@ -0,0 +1,155 @@
+/*
+ * fenwick_tree.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "aikartos/utils/extent_storage.hpp"
+
+namespace aikartos::utils {
+
+	// Binary indexed tree over per-slot weights: O(log n) weight change and
+	// O(log n) search of the slot a point of the total falls into (a weighted draw).
+	template <std::size_t Extent>
+	class fenwick_tree {
+	public:
+		using value_type = std::uint32_t;
+
+		// Makes room for 'count' slots, the new ones weigh 0. false if the heap is exhausted
+		bool reserve(std::size_t count) {
+			if(count <= size_) {
+				return true;
+			}
+			if(!values_.reserve(count) || !tree_.reserve(count + 1)) {
+				return false;
+			}
+			size_ = count;
+			rebuild();
+			return true;
+		}
+
+		std::size_t size() const {
+			return size_;
+		}
+
+		value_type get(std::size_t slot) const {
+			return values_[slot];
+		}
+
+		void set(std::size_t slot, value_type value) {
+			const auto old = values_[slot];
+			values_[slot] = value;
+			total_ += value - old;
+			// the tree takes the difference modulo 2^32, the sums stay right
+			for(auto i = slot + 1; i <= size_; i += lowest_bit(i)) {
+				tree_[i] += value - old;
+			}
+		}
+
+		value_type total() const {
+			return total_;
+		}
+
+		// 1-based tree node: the sum of the lowest_bit(index) slots that end at slot index - 1
+		value_type node(std::size_t index) const {
+			return tree_[index];
+		}
+
+		// The slot whose weight range holds 'point' (point < total()): the first slot with prefix sum > point
+		std::size_t find(value_type point) const {
+			std::size_t position = 0;
+			for(auto step = std::bit_floor(size_); step != 0; step >>= 1) {
+				const auto next = position + step;
+				if((next <= size_) && (tree_[next] <= point)) {
+					point -= tree_[next];
+					position = next;
+				}
+			}
+			return position;
+		}
+
+	private:
+
+		static std::size_t lowest_bit(std::size_t value) {
+			return value & (~value + 1);
+		}
+
+		// O(n): every node takes its slot, then adds itself to its parent
+		void rebuild() {
+			total_ = 0;
+			for(std::size_t i = 1; i <= size_; ++i) {
+				tree_[i] = values_[i - 1];
+				total_ += values_[i - 1];
+			}
+			for(std::size_t i = 1; i <= size_; ++i) {
+				const auto parent = i + lowest_bit(i);
+				if(parent <= size_) {
+					tree_[parent] += tree_[i];
+				}
+			}
+		}
+
+		utils::extent_storage<value_type, Extent> values_;
+		// 1-based
+		utils::extent_storage<value_type, (Extent == utils::dynamic_extent) ? Extent : Extent + 1> tree_;
+		std::size_t size_ = 0;
+		value_type total_ = 0;
+	};
+
+	// Per-slot weights that change linearly with one shared argument: weight = base + slope * x.
+	// A whole group of weights grows with x and nothing is written, a slot changes its line in O(log n).
+	// Sums are taken modulo 2^32, only the real weights and their sums have to fit 32 bits
+	template <std::size_t Extent>
+	class linear_fenwick_tree {
+	public:
+		using value_type = std::uint32_t;
+
+		bool reserve(std::size_t count) {
+			return base_.reserve(count) && slope_.reserve(count);
+		}
+
+		std::size_t size() const {
+			return base_.size();
+		}
+
+		void set(std::size_t slot, value_type base, value_type slope) {
+			base_.set(slot, base);
+			slope_.set(slot, slope);
+		}
+
+		value_type get(std::size_t slot, value_type x) const {
+			return base_.get(slot) + slope_.get(slot) * x;
+		}
+
+		value_type total(value_type x) const {
+			return base_.total() + slope_.total() * x;
+		}
+
+		// fenwick_tree::find over the weights at 'x' (point < total(x))
+		std::size_t find(value_type point, value_type x) const {
+			std::size_t position = 0;
+			for(auto step = std::bit_floor(size()); step != 0; step >>= 1) {
+				const auto next = position + step;
+				if(next <= size()) {
+					const auto weight = base_.node(next) + slope_.node(next) * x;
+					if(weight <= point) {
+						point -= weight;
+						position = next;
+					}
+				}
+			}
+			return position;
+		}
+
+	private:
+		fenwick_tree<Extent> base_;
+		fenwick_tree<Extent> slope_;
+	};
+}
@@ -0,0 +1,74 @@
+/*
+ * histogram.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace aikartos::utils {
+
+	// Fixed-width buckets: [0, W), [W, 2W) ... The last bucket also takes everything above the range.
+	template <std::size_t BucketsCount, std::uint32_t BucketWidth>
+	class histogram {
+	public:
+
+		static_assert(BucketsCount > 0, "Histogram needs at least one bucket");
+		static_assert(BucketWidth > 0, "Bucket width can't be 0");
+
+		using value_type = std::uint32_t;
+		constexpr static std::size_t buckets_count = BucketsCount;
+		constexpr static value_type bucket_width = BucketWidth;
+
+		void add(value_type value) {
+			auto bucket = value / bucket_width;
+			if(bucket >= buckets_count) {
+				bucket = buckets_count - 1;
+			}
+			buckets_[bucket] += 1;
+			count_ += 1;
+			min_ = (value < min_) ? value : min_;
+			max_ = (value > max_) ? value : max_;
+		}
+
+		void reset() {
+			buckets_.fill(0);
+			count_ = 0;
+			min_ = std::numeric_limits<value_type>::max();
+			max_ = 0;
+		}
+
+		std::uint32_t count() const { return count_; }
+		value_type min() const { return count_ ? min_ : 0; }
+		value_type max() const { return max_; }
+		std::uint32_t bucket(std::size_t id) const { return (id < buckets_count) ? buckets_[id] : 0; }
+
+		// Upper bound of the bucket that holds the given percentile (0..100), clamped by max()
+		value_type percentile(std::uint32_t percent) const {
+			if(count_ == 0) {
+				return 0;
+			}
+			const auto target = (static_cast<std::uint64_t>(count_) * percent + 99) / 100;
+			std::uint64_t seen = 0;
+			for(std::size_t i = 0; i < buckets_count; ++i) {
+				seen += buckets_[i];
+				if((seen >= target) && (seen > 0)) {
+					const auto upper = static_cast<value_type>((i + 1) * bucket_width - 1);
+					return (upper < max_) ? upper : max_;
+				}
+			}
+			return max_;
+		}
+
+	private:
+		std::array<std::uint32_t, buckets_count> buckets_ = {};
+		std::uint32_t count_ = 0;
+		value_type min_ = std::numeric_limits<value_type>::max();
+		value_type max_ = 0;
+	};
+}
@@ -0,0 +1,137 @@
+/*
+ * intrusive_list.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include "aikartos/utils/container_of.hpp"
+
+namespace aikartos::utils {
+
+	// The hook an object carries to be linked into an intrusive_list. One list at a time
+	struct list_node {
+		list_node *prev = nullptr;
+		list_node *next = nullptr;
+
+		bool is_linked() const {
+			return next != nullptr;
+		}
+
+		// O(1), the list itself is not needed
+		void unlink() {
+			prev->next = next;
+			next->prev = prev;
+			prev = nullptr;
+			next = nullptr;
+		}
+	};
+
+	// Doubly linked circular list over the objects' own hooks: no storage, no size limit, O(1) removal.
+	// The list holds a sentinel node, it can't be copied or moved while anything is linked
+	template <typename T, list_node T::*Node>
+	class intrusive_list {
+	public:
+		using value_type = T;
+
+		intrusive_list() {
+			root_.prev = &root_;
+			root_.next = &root_;
+		}
+
+		intrusive_list(const intrusive_list &) = delete;
+		intrusive_list &operator = (const intrusive_list &) = delete;
+
+		bool empty() const {
+			return root_.next == &root_;
+		}
+
+		// nullptr if empty
+		value_type *front() const {
+			return empty() ? nullptr : to_value(root_.next);
+		}
+
+		value_type *back() const {
+			return empty() ? nullptr : to_value(root_.prev);
+		}
+
+		// The value must not be linked
+		void push_back(value_type *value) {
+			insert_before(&root_, &(value->*Node));
+		}
+
+		void push_front(value_type *value) {
+			insert_before(root_.next, &(value->*Node));
+		}
+
+		value_type *pop_front() {
+			auto *value = front();
+			if(value) {
+				(value->*Node).unlink();
+			}
+			return value;
+		}
+
+		// false if the value was not linked
+		static bool remove(value_type *value) {
+			auto &node = value->*Node;
+			if(!node.is_linked()) {
+				return false;
+			}
+			node.unlink();
+			return true;
+		}
+
+		static bool contains(const value_type *value) {
+			return (value->*Node).is_linked();
+		}
+
+		// Relinks a linked value at the back
+		void move_to_back(value_type *value) {
+			auto *node = &(value->*Node);
+			if(node->next == &root_) {
+				return;
+			}
+			node->unlink();
+			insert_before(&root_, node);
+		}
+
+		// cb(value_type *). The current value may be removed from the callback
+		template <typename CallBackT>
+		void foreach(CallBackT cb) const {
+			for(auto *node = root_.next; node != &root_; ) {
+				auto *next = node->next;
+				cb(to_value(node));
+				node = next;
+			}
+		}
+
+		// The first value pred(value_type *) is true for, nullptr if none
+		template <typename PredicateT>
+		value_type *find_if(PredicateT pred) const {
+			for(auto *node = root_.next; node != &root_; node = node->next) {
+				if(pred(to_value(node))) {
+					return to_value(node);
+				}
+			}
+			return nullptr;
+		}
+
+	private:
+
+		static value_type *to_value(list_node *node) {
+			return utils::container_of<value_type>(node, Node);
+		}
+
+		static void insert_before(list_node *position, list_node *node) {
+			node->prev = position->prev;
+			node->next = position;
+			position->prev->next = node;
+			position->prev = node;
+		}
+
+		list_node root_;
+	};
+}
@@ -8,9 +8,17 @@
 #pragma once
 
 #include "aikartos/kernel/panic.hpp"
+#include "aikartos/utils/extent_storage.hpp"
 #include "aikartos/utils/light_bitset.hpp"
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#if !defined(UTILS_OBJECT_POOL_CHUNK_BYTES)
+#	define UTILS_OBJECT_POOL_CHUNK_BYTES 256
+#endif
 
 namespace aikartos::utils {
 	template<typename T, std::size_t MaximumObjects, std::size_t DataAlign = 8>
@@ -65,6 +73,23 @@ namespace aikartos::utils {
 			}
 		}
 
+		bool owns(const element_type *ptr) const {
+			const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+			const auto begin = reinterpret_cast<std::uintptr_t>(at(0));
+			const auto end = reinterpret_cast<std::uintptr_t>(at(maximum_objects));
+			return (address < end) && (address >= begin);
+		}
+
+		// Calls 'fn' for every allocated object
+		template <typename FuncT>
+		void foreach(FuncT fn) {
+			for (std::size_t slot = 0; slot < maximum_objects; ++slot) {
+				if (allowed_objects_.test(slot)) {
+					fn(at(slot));
+				}
+			}
+		}
+
 	private:
 
 		std::size_t find_free_slot() {
@@ -74,4 +99,129 @@ namespace aikartos::utils {
 		utils::light_bitset<MaximumObjects> allowed_objects_;
 		alignas(data_align) object_array data;
 	};
+
+	// Grows on demand: objects live in heap chunks of 'chunk_objects', linked together.
+	// Chunks are never returned. Free slots of all the chunks make one list and every slot
+	// knows its chunk, so alloc and free are O(1); owns walks the chunks
+	template<typename T, std::size_t DataAlign>
+	class object_pool<T, dynamic_extent, DataAlign> {
+	public:
+
+		using element_type = T;
+		constexpr static std::size_t data_align = DataAlign;
+		constexpr static std::size_t maximum_objects = dynamic_extent;
+		constexpr static std::size_t object_size = sizeof(element_type);
+		constexpr static std::size_t chunk_bytes = UTILS_OBJECT_POOL_CHUNK_BYTES;
+		// Small objects share a chunk, an object of chunk_bytes or more (a task with its stack) gets its own
+		constexpr static std::size_t chunk_objects = (object_size >= chunk_bytes) ? 1 : (chunk_bytes / object_size);
+
+		using object_ptr = element_type*;
+
+		object_pool() = default;
+		object_pool(const object_pool &) = delete;
+		object_pool &operator = (const object_pool &) = delete;
+
+		template<typename ...Args>
+		object_ptr alloc(Args &&...args) {
+			if ((free_slots_ == nullptr) && !add_chunk()) {
+				PANIC("No memory for the pool chunk!");
+				return nullptr;
+			}
+			auto *s = free_slots_;
+			free_slots_ = s->next_free;
+			s->next_free = nullptr;
+			s->owner->allowed_objects.set(s->owner->index_of(s));
+			return new (static_cast<void*>(s->data)) element_type(std::forward<Args>(args)...);
+		}
+
+		// 'ptr' has to come from this pool
+		void free(element_type *ptr) {
+			auto *s = slot_of(ptr);
+			auto *c = s->owner;
+			const auto slot = c->index_of(s);
+#ifdef DEBUG
+			ASSERT(c->allowed_objects.test(slot), "Object is not allocated");
+#endif
+			if (c->allowed_objects.test(slot)) {
+				c->allowed_objects.clear(slot);
+				ptr->~T();
+				s->next_free = free_slots_;
+				free_slots_ = s;
+			}
+		}
+
+		bool owns(const element_type *ptr) const {
+			const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+			for (auto *c = chunks_; c != nullptr; c = c->next) {
+				if ((address >= reinterpret_cast<std::uintptr_t>(&c->slots[0]))
+					&& (address < reinterpret_cast<std::uintptr_t>(&c->slots[chunk_objects]))) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		template <typename FuncT>
+		void foreach(FuncT fn) {
+			for (auto *c = chunks_; c != nullptr; c = c->next) {
+				for (std::size_t slot = 0; slot < chunk_objects; ++slot) {
+					if (c->allowed_objects.test(slot)) {
+						fn(c->slots[slot].get());
+					}
+				}
+			}
+		}
+
+	private:
+
+		struct chunk;
+
+		struct slot {
+			T* get() noexcept {
+				return std::launder(reinterpret_cast<T*>(data));
+			}
+
+			chunk *owner = nullptr;
+			slot *next_free = nullptr;
+			alignas(data_align) std::byte data[sizeof(element_type)];
+		};
+
+		struct chunk {
+			std::size_t index_of(const slot *s) const {
+				return static_cast<std::size_t>(s - slots);
+			}
+
+			chunk *next = nullptr;
+			void *memory = nullptr;
+			utils::light_bitset<chunk_objects> allowed_objects;
+			slot slots[chunk_objects];
+		};
+
+		static slot *slot_of(element_type *ptr) {
+			return reinterpret_cast<slot *>(reinterpret_cast<std::byte *>(ptr) - offsetof(slot, data));
+		}
+
+		bool add_chunk() {
+			auto *memory = std::malloc(sizeof(chunk) + alignof(chunk) - 1);
+			if (memory == nullptr) {
+				return false;
+			}
+			const auto address = (reinterpret_cast<std::uintptr_t>(memory) + alignof(chunk) - 1) & ~(alignof(chunk) - 1);
+			auto *c = new (reinterpret_cast<void *>(address)) chunk;
+			c->memory = memory;
+			c->next = chunks_;
+			chunks_ = c;
+			// in order: the first allocations take the first slots
+			for (std::size_t id = chunk_objects; id > 0; --id) {
+				auto *s = &c->slots[id - 1];
+				s->owner = c;
+				s->next_free = free_slots_;
+				free_slots_ = s;
+			}
+			return true;
+		}
+
+		chunk *chunks_ = nullptr;
+		slot *free_slots_ = nullptr;
+	};
 }
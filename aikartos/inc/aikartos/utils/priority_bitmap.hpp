@@ -0,0 +1,86 @@
+/*
+ * priority_bitmap.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace aikartos::utils {
+
+	// Set of non-empty priority levels, 0 is the highest. highest() is one CLZ up to 32 levels
+	// and two CLZ (a summary word over the level words) up to 1024.
+	// Level 'p' is bit (31 - p % 32) of its word, so the leading zero count is the level itself.
+	template <std::size_t Levels>
+	class priority_bitmap {
+	public:
+		constexpr static std::size_t levels = Levels;
+		constexpr static std::size_t word_bits = 32;
+		constexpr static std::size_t word_count = (levels + word_bits - 1) / word_bits;
+		// highest() on an empty bitmap
+		constexpr static std::size_t npos = levels;
+
+		static_assert(levels > 0 && word_count <= word_bits, "1..1024 levels");
+
+		void set(std::size_t level) {
+			const auto word = level / word_bits;
+			words_[word] |= bit(level % word_bits);
+			if constexpr (word_count > 1) {
+				summary_ |= bit(word);
+			}
+		}
+
+		void clear(std::size_t level) {
+			const auto word = level / word_bits;
+			words_[word] &= ~bit(level % word_bits);
+			if constexpr (word_count > 1) {
+				if(words_[word] == 0) {
+					summary_ &= ~bit(word);
+				}
+			}
+		}
+
+		bool test(std::size_t level) const {
+			return (words_[level / word_bits] & bit(level % word_bits)) != 0;
+		}
+
+		bool empty() const {
+			if constexpr (word_count > 1) {
+				return summary_ == 0;
+			}
+			else {
+				return words_[0] == 0;
+			}
+		}
+
+		std::size_t highest() const {
+			if constexpr (word_count > 1) {
+				if(summary_ == 0) {
+					return npos;
+				}
+				const auto word = static_cast<std::size_t>(std::countl_zero(summary_));
+				return word * word_bits + static_cast<std::size_t>(std::countl_zero(words_[word]));
+			}
+			else {
+				if(words_[0] == 0) {
+					return npos;
+				}
+				return static_cast<std::size_t>(std::countl_zero(words_[0]));
+			}
+		}
+
+	private:
+
+		constexpr static std::uint32_t bit(std::size_t position) {
+			return std::uint32_t{ 0x8000'0000 } >> position;
+		}
+
+		std::uint32_t words_[word_count] = {};
+		std::uint32_t summary_ = 0;
+	};
+}
@@ -0,0 +1,226 @@
+/*
+ * timing_wheel.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace aikartos::utils {
+
+	// Intrusive node of timing_wheel. Lives inside its owner, see utils::container_of
+	struct timing_node {
+		using expire_handler = void(*)(timing_node *);
+
+		timing_node *prev = nullptr;
+		timing_node *next = nullptr;
+		timing_node **head = nullptr; // the slot the node is linked to, nullptr if it's not in the wheel
+		std::uint32_t expiry = 0;
+		expire_handler on_expire = nullptr;
+
+		inline bool is_linked() const {
+			return head != nullptr;
+		}
+	};
+
+	// Hierarchical timing wheel (Varghese & Lauck).
+	// Level N slot covers slots^N ticks. Insert and cancel are O(1),
+	// advance is amortized O(1) per tick: a node is moved down at most Levels - 1 times.
+	// Not thread safe, the owner takes care of the locking.
+	template <std::size_t LevelBits = 5, std::size_t Levels = 5>
+	class timing_wheel {
+	public:
+		static_assert(LevelBits > 0 && LevelBits <= 5, "occupancy of a level is a single 32-bit word");
+		static_assert(Levels > 0 && (LevelBits * Levels) < 32, "the wheel has to fit 32-bit ticks");
+
+		constexpr static std::size_t level_bits = LevelBits;
+		constexpr static std::size_t levels = Levels;
+		constexpr static std::size_t slots = std::size_t{1} << level_bits;
+		constexpr static std::uint32_t slot_mask = slots - 1;
+		// farther expiries are parked at the top level and go around again
+		constexpr static std::uint32_t span = std::uint32_t{1} << (level_bits * levels);
+
+		// The node expires as soon as the wheel reaches 'expiry'. A node that is already due expires right away.
+		void insert(timing_node *node, std::uint32_t expiry) {
+			node->expiry = expiry;
+			if(static_cast<std::int32_t>(expiry - current_) <= 0) {
+				node->on_expire(node);
+				return;
+			}
+			link(node);
+		}
+
+		// false if the node is not in the wheel (never inserted or already expired)
+		bool cancel(timing_node *node) {
+			if(!node->is_linked()) {
+				return false;
+			}
+			unlink(node);
+			return true;
+		}
+
+		// Expires everything up to 'now' inclusive.
+		void advance(std::uint32_t now) {
+			while(static_cast<std::int32_t>(now - current_) > 0) {
+				if(occupied_[0] == 0) {
+					// nothing to expire at level 0 before its wrap, jump straight to the last slot
+					const std::uint32_t to_wrap = slot_mask - (current_ & slot_mask);
+					const std::uint32_t left = now - current_;
+					if(to_wrap >= left) {
+						current_ = now;
+						break;
+					}
+					current_ += to_wrap;
+				}
+				current_ += 1;
+				cascade();
+				expire(0, current_ & slot_mask);
+			}
+		}
+
+		// The tick the wheel has to be advanced to, at the latest, to expire or cascade the earliest node.
+		std::optional<std::uint32_t> next_expiry() const {
+			std::optional<std::uint32_t> result;
+			std::uint32_t nearest = 0;
+			for(std::size_t level = 0; level < levels; ++level) {
+				if(occupied_[level] == 0) {
+					continue;
+				}
+				const auto shift = level * level_bits;
+				const auto index = (current_ >> shift) & slot_mask;
+				const auto start = ((current_ >> shift) + distance(occupied_[level], index)) << shift;
+				const auto delta = start - current_;
+				if(!result || (delta < nearest)) {
+					nearest = delta;
+					result = start;
+				}
+			}
+			return result;
+		}
+
+		template <typename CallBackT>
+		void foreach(CallBackT cb) {
+			for(std::size_t level = 0; level < levels; ++level) {
+				for(std::size_t slot = 0; slot < slots; ++slot) {
+					for(auto *node = slots_[level][slot]; node != nullptr; node = node->next) {
+						cb(node);
+					}
+				}
+			}
+		}
+
+		inline std::uint32_t now() const {
+			return current_;
+		}
+
+		inline bool empty() const {
+			for(std::size_t level = 0; level < levels; ++level) {
+				if(occupied_[level] != 0) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+
+		// slots after 'index' come first, 'index' itself is a full turn away
+		static std::uint32_t distance(std::uint32_t occupied, std::uint32_t index) {
+			const std::uint32_t from = (index + 1) & slot_mask;
+			std::uint32_t rotated = (from == 0) ? occupied : ((occupied >> from) | (occupied << (slots - from)));
+			if constexpr (slots < 32) {
+				rotated &= (std::uint32_t{1} << slots) - 1;
+			}
+			return static_cast<std::uint32_t>(std::countr_zero(rotated)) + 1;
+		}
+
+		void link(timing_node *node) {
+			const std::uint32_t delta = node->expiry - current_;
+			const std::uint32_t target = (delta < span) ? node->expiry : (current_ + span - 1);
+			const std::uint32_t clamped = target - current_;
+
+			std::size_t level = 0;
+			while((level + 1 < levels) && (clamped >= (std::uint32_t{1} << (level_bits * (level + 1))))) {
+				++level;
+			}
+			const auto slot = (target >> (level * level_bits)) & slot_mask;
+
+			auto **head = &slots_[level][slot];
+			node->head = head;
+			node->prev = nullptr;
+			node->next = *head;
+			if(*head) {
+				(*head)->prev = node;
+			}
+			*head = node;
+			occupied_[level] |= (std::uint32_t{1} << slot);
+		}
+
+		void unlink(timing_node *node) {
+			if(node->prev) {
+				node->prev->next = node->next;
+			}
+			else {
+				*node->head = node->next;
+			}
+			if(node->next) {
+				node->next->prev = node->prev;
+			}
+			if(*node->head == nullptr) {
+				const auto index = static_cast<std::size_t>(node->head - &slots_[0][0]);
+				occupied_[index / slots] &= ~(std::uint32_t{1} << (index % slots));
+			}
+			node->head = nullptr;
+			node->prev = nullptr;
+			node->next = nullptr;
+		}
+
+		// detaches the whole slot, the handlers are free to insert the nodes again
+		timing_node *take(std::size_t level, std::size_t slot) {
+			auto *list = slots_[level][slot];
+			slots_[level][slot] = nullptr;
+			occupied_[level] &= ~(std::uint32_t{1} << slot);
+			for(auto *node = list; node != nullptr; node = node->next) {
+				node->head = nullptr;
+			}
+			return list;
+		}
+
+		// on a level wrap the next slot of the upper level is spread over the lower ones
+		void cascade() {
+			for(std::size_t level = 1; level < levels; ++level) {
+				const auto shift = level * level_bits;
+				if((current_ & ((std::uint32_t{1} << shift) - 1)) != 0) {
+					break;
+				}
+				auto *list = take(level, (current_ >> shift) & slot_mask);
+				while(list) {
+					auto *node = list;
+					list = list->next;
+					insert(node, node->expiry);
+				}
+			}
+		}
+
+		void expire(std::size_t level, std::size_t slot) {
+			auto *list = take(level, slot);
+			while(list) {
+				auto *node = list;
+				list = list->next;
+				node->prev = nullptr;
+				node->next = nullptr;
+				node->on_expire(node);
+			}
+		}
+
+		timing_node *slots_[levels][slots] = {};
+		std::uint32_t occupied_[levels] = {};
+		std::uint32_t current_ = 0;
+	};
+}
@@ -6,13 +6,15 @@
 .type PendSV_Handler1, %function
 .align 2
 PendSV_Handler1:   //;save r0,r1,r2,r3,r12,lr,pc,psr
-        // Disable interrupts during context switch
-        CPSID   I
+        // Mask the kernel interrupts during context switch
+        LDR     R0, =g_kernel_basepri
+        LDR     R0, [R0]
+        MSR     BASEPRI, R0
 
-        // Save current task context: read PSP
-        MRS     R0, PSP
-        // Push callee-saved registers R4–R11 onto current task's stack
-        STMDB   R0!, {R4-R11}
+        // Ask for the next task first: R0 = pendsv_handler_impl()
+        PUSH    {R3, LR}
+        BL      pendsv_handler_impl
+        POP     {R3, LR}
 
         // Load address of current_tcb_ptr (global pointer to current task)
         LDR     R1, =g_current_tcb_ptr
@@ -20,20 +22,34 @@ PendSV_Handler1:   //;save r0,r1,r2,r3,r12,lr,pc,psr
         // Load current TCB (current_tcb_ptr)
         LDR     R2, [R1]
 
+        // Same task: nothing to save or restore
+        CMP     R0, R2
+        BNE     1f
+        MOV     R0, #0
+        MSR     BASEPRI, R0
+        BX      LR
+1:
+        // current_tcb_ptr = next
+        STR     R0, [R1]
+        MOV     R12, R0
+
+        // Save current task context: read PSP
+        MRS     R0, PSP
+        // Push callee-saved registers R4–R11 onto current task's stack
+        STMDB   R0!, {R4-R11}
+
         // Save updated PSP into current TCB
         STR     R0, [R2]
 
-        // Call C function to switch to next task: current_tcb_ptr = scheduler.get_next()
-        PUSH    {LR}
-        BL      pendsv_handler_impl
-        POP     {LR}
-
-         // Load new current_tcb_ptr after switch
-        LDR     R1, =g_current_tcb_ptr
-        LDR     R2, [R1]
+        // pendsv_switch_impl(prev, next): per-task accounting
+        MOV     R0, R2
+        MOV     R1, R12
+        PUSH    {R12, LR}
+        BL      pendsv_switch_impl
+        POP     {R12, LR}
 
         // Load new task's saved stack pointer
-        LDR     R0, [R2, #0]
+        LDR     R0, [R12, #0]
 
         // Restore callee-saved registers for new task
         LDMIA   R0!, {R4-R11}
@@ -41,8 +57,9 @@ PendSV_Handler1:   //;save r0,r1,r2,r3,r12,lr,pc,psr
         // Set PSP to point to new task's stack
         MSR     PSP, R0
 
-        // Re-enable interrupts
-        CPSIE   I
+        // Unmask the kernel interrupts
+        MOV     R0, #0
+        MSR     BASEPRI, R0
 
         // Return from interrupt — remaining registers restored automatically (R0–R3, R12, LR, PC, xPSR)
         BX      LR
@@ -9,14 +9,48 @@
 
 aikartos::kernel::core::task_block *g_current_tcb_ptr = nullptr;
 
+// PendSV_Handler masks the kernel interrupts with it (sync::kernel_critical_section)
+extern "C" const std::uint32_t g_kernel_basepri = aikartos::constants::kernel_basepri;
+
+#if defined(KERNEL_USE_PROFILING)
+volatile std::uint32_t g_pendsv_enter_cycles = 0;
+volatile std::uint32_t g_pendsv_exit_cycles = 0;
+
+// Stores DWT->CYCCNT into 'var', uses R1 and R3 only
+#	define PENDSV_PROFILE_STAMP(var) \
+		asm volatile ("LDR     R1, =0xE0001004"); /* &DWT->CYCCNT */ \
+		asm volatile ("LDR     R1, [R1]"); \
+		asm volatile ("LDR     R3, =" #var); \
+		asm volatile ("STR     R1, [R3]")
+#else
+#	define PENDSV_PROFILE_STAMP(var)
+#endif
+
 namespace aikartos::kernel {
 	struct handlers_friend {
 
+		// The two words are not updated at once: readers take them inside a kernel critical section
+		// (core::get_tick_fraction), so only an interrupt above the ceiling could see a torn value
+		static void count_ticks(std::uint32_t ticks) {
+			const std::uint32_t before = core::tick_count_;
+			core::tick_count_ = before + ticks;
+			if(core::tick_count_ < before) {
+				core::tick_count_high_ += 1;
+			}
+			sleep_queue::advance(core::tick_count_);
+		}
+
 		static void systick_handler() {
-			kernel::core::tick_count_ += 1;
+			count_ticks(1);
 			static volatile std::uint32_t counter = 0;
 			static volatile std::uint32_t quanta = core::get_quanta();
 
+			// a yield_to without donation: the target starts a fresh quanta
+			if(core::restart_quanta_) {
+				core::restart_quanta_ = false;
+				counter = 0;
+			}
+
 #if 0
 			counter += 1;
 			if((constants::quanta_infinite != quanta) && (counter >= quanta)) {
@@ -25,6 +59,15 @@ namespace aikartos::kernel {
 			}
 #else
 			volatile std::uint32_t current_quanta = core::get_quanta();
+
+			// A woken task that outranks the running one gets the CPU now, not at the end of the quanta
+			if(auto *wakeup_check = impl_base::get_wakeup_check()) {
+				if(sleep_queue::any_woken([wakeup_check](auto *waker) { return wakeup_check(g_current_tcb_ptr, waker); })) {
+					counter = 0;
+					SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+				}
+			}
+
 			if(auto *hook = kernel::core::get_systick_hook()) {
 				if(hook(kernel::core::get_systick_hook_parameter())) {
 					counter = 0;
@@ -47,40 +90,183 @@ namespace aikartos::kernel {
 #endif
 		}
 
-		static void pendsv_handler() {
-			while (1) {
-			    auto [next, event] = kernel::core::instance_->get_next_task();
-			    g_current_tcb_ptr = next;
-			    if (event != sch::events::OK && kernel::core::get_scheduler_event_handler()) {
-			        auto decision = kernel::core::get_scheduler_event_handler()(event);
-			        if (decision == sch::decision::RETRY) {
-			            continue;
-			        }
-			    }
-			    break;
+		static void tickless_idle(impl_base::next_wakeup_type next_wakeup) {
+			const std::uint32_t cycles_per_tick = core::systick_cycles_per_tick_;
+			const std::uint32_t maximum_ticks = SysTick_LOAD_RELOAD_Msk / cycles_per_tick;
+
+			// PRIMASK, not a priority mask: WFI has to wake up on any interrupt
+			__disable_irq();
+
+			std::uint32_t idle_ticks = maximum_ticks;
+			if(auto wakeup = next_wakeup()) {
+				const auto delta = static_cast<std::int32_t>(*wakeup - core::tick_count_);
+				idle_ticks = (delta > 0) ? static_cast<std::uint32_t>(delta) : 0;
+			}
+			if(idle_ticks > maximum_ticks) {
+				idle_ticks = maximum_ticks;
+			}
+
+			// nothing to save or the tick is already pending
+			if((idle_ticks < 2) || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+				__enable_irq();
+				__WFI();
+				return;
+			}
+
+			SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+			// the current tick has already partially elapsed
+			const std::uint32_t reload = SysTick->VAL + (idle_ticks - 1) * cycles_per_tick;
+			SysTick->LOAD = reload;
+			SysTick->VAL = 0;
+			SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+			__DSB();
+			__WFI();
+			__ISB();
+
+			// Stopped with a plain write first: a read-modify-write would read CTRL twice, and reading clears
+			// COUNTFLAG, so an expiry between the two reads would be lost. The flag survives the write
+			SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk;
+			const std::uint32_t ctrl = SysTick->CTRL;
+
+			std::uint32_t elapsed_ticks = 0;
+			if(ctrl & SysTick_CTRL_COUNTFLAG_Msk) {
+				// The one-shot interval expired. The pending SysTick interrupt will count the last tick.
+				std::uint32_t next_load = (cycles_per_tick - 1) - (reload - SysTick->VAL);
+				if(next_load > cycles_per_tick) {
+					next_load = cycles_per_tick - 1;
+				}
+				SysTick->LOAD = next_load;
+				elapsed_ticks = idle_ticks - 1;
+			}
+			else {
+				// Some other interrupt woke the core up. Count the complete ticks and keep the remainder.
+				const std::uint32_t elapsed_cycles = (idle_ticks * cycles_per_tick) - SysTick->VAL;
+				elapsed_ticks = elapsed_cycles / cycles_per_tick;
+				SysTick->LOAD = ((elapsed_ticks + 1) * cycles_per_tick) - elapsed_cycles;
 			}
+
+			SysTick->VAL = 0;
+			SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+			SysTick->LOAD = cycles_per_tick - 1;
+
+			count_ticks(elapsed_ticks);
+
+			__enable_irq();
+		}
+
+		// Makes the scheduling decision only. g_current_tcb_ptr still points to the running task,
+		// PendSV_Handler compares the result with it and skips the switch if they are equal.
+		// NB: the running task can already be released by the scheduler (DONE).
+		// Its slot stays untouched until PendSV_Handler has stored the context into it.
+		static core::task_block *pendsv_handler() {
+			return core::select_next_task();
 		}
+
+		// Called by PendSV_Handler on a real switch, after the outgoing context (including s16-s31) is stored
+		static void pendsv_switch(core::task_block *prev, core::task_block *next) {
+			const auto now = device::cycle_counter::now();
+
+			auto &prev_acc = prev->accounting;
+			prev_acc.cycles += (now - prev_acc.switched_in);
+			prev_acc.last_run = now;
+			if(core::voluntary_switch_) {
+				prev_acc.yields += 1;
+			}
+			else {
+				prev_acc.preemptions += 1;
+			}
+
+			next->accounting.dispatches += 1;
+			next->accounting.switched_in = now;
+
+#if defined(PLATFORM_USE_FPU)
+			if(impl_base::get_fpu_auto_enable()) {
+				set_fpu_access(next->is_fpu_used());
+			}
+#endif
+#if defined(KERNEL_USE_STACK_GUARD)
+			set_stack_guard(next);
+#endif
+		}
+
+#if defined(KERNEL_USE_STACK_GUARD)
+		// The highest MPU region (core::launch reads it from MPU->TYPE): no access, 32 bytes at the bottom of the task stack
+		static void set_stack_guard(const core::task_block *task) {
+			constexpr std::uint32_t size_32_bytes = 4; // 2^(SIZE + 1)
+			MPU->RBAR = task->stack_guard_address() | MPU_RBAR_VALID_Msk | (core::stack_guard_region_ << MPU_RBAR_REGION_Pos);
+			MPU->RASR = MPU_RASR_XN_Msk | (size_32_bytes << MPU_RASR_SIZE_Pos) | MPU_RASR_ENABLE_Msk;
+			__DSB();
+			__ISB();
+		}
+#endif
+
+#if defined(PLATFORM_USE_FPU)
+		static void set_fpu_access(bool value) {
+			constexpr std::uint32_t cp10_cp11_full_access = (3UL << 10*2) | (3UL << 11*2);
+			if(value) {
+				SCB->CPACR |= cp10_cp11_full_access;
+			}
+			else {
+				SCB->CPACR &= ~cp10_cp11_full_access;
+			}
+			__DSB();
+			__ISB();
+		}
+
+		static void usage_fault_handler(std::uint32_t *stack_frame, std::uint32_t exc_return) {
+			if(impl_base::get_fpu_auto_enable() && (SCB->CFSR & SCB_CFSR_NOCP_Msk)) {
+				SCB->CFSR = SCB_CFSR_NOCP_Msk; // write-1-to-clear
+				// A thread on PSP is a task: remember it, so every next switch to it grants the access.
+				// Handler mode (kernel code, VSTMDB in PendSV) just gets the access until the next switch.
+				if((exc_return & (1 << 2)) && (g_current_tcb_ptr != nullptr)) {
+					g_current_tcb_ptr->enable_fpu();
+				}
+				set_fpu_access(true);
+				// UsageFault is precise: the faulting instruction is executed again
+				return;
+			}
+			hard_fault_handler(stack_frame);
+		}
+#endif
 	};
 
+	/// impl_base
+	void impl_base::tickless_idle(impl_base::next_wakeup_type next_wakeup) {
+		handlers_friend::tickless_idle(next_wakeup);
+	}
+	/// impl_base
+
 	/// core
-	void core::add_task(core::task_entry task, const tasks::config &config, core::task_parameter parameter) {
+	core::task_block *core::add_task(core::task_entry task, const tasks::config &config, core::task_parameter parameter) {
 		auto added = instance_->add_task(task, parameter, config);
 		if(nullptr == g_current_tcb_ptr) {
 			g_current_tcb_ptr = added;
 		}
+		return added;
 	}
 	void core::init_first_task() {
-	    auto [next, _] = instance_->get_next_task();
+		sch::scheduler_specific_event event = sch::events::OK;
+		auto next = instance_->get_next_task(event);
 		g_current_tcb_ptr = next;
+		next->accounting.dispatches += 1;
+		next->accounting.switched_in = device::cycle_counter::now();
+#if defined(KERNEL_USE_STACK_GUARD)
+		handlers_friend::set_stack_guard(next);
+#endif
+#if defined(PLATFORM_USE_FPU)
+		if(impl_base::get_fpu_auto_enable()) {
+			handlers_friend::set_fpu_access(next->is_fpu_used());
+		}
+#endif
 	}
 	// core
 
 	/// kernel::api
 	core::task_block *api::get_current_tcb() {
-		__disable_irq();
-		auto cptr = g_current_tcb_ptr;
-		__enable_irq();
-		return cptr;
+		// a single word, the read is atomic
+		return g_current_tcb_ptr;
 	}
 
 	std::uint32_t api::get_tick_count() {
@@ -92,81 +278,144 @@ namespace aikartos::kernel {
 
 extern "C" {
 
-	void pendsv_handler_impl() {
-		aikartos::kernel::handlers_friend::pendsv_handler();
+	// Weak: replaced by AIKARTOS_KERNEL_STATIC_DISPATCH (kernel/static_dispatch.hpp)
+	__attribute__((weak)) aikartos::kernel::core::task_block *pendsv_handler_impl() {
+		return aikartos::kernel::handlers_friend::pendsv_handler();
+	}
+
+	void pendsv_switch_impl(aikartos::kernel::core::task_block *prev, aikartos::kernel::core::task_block *next) {
+		aikartos::kernel::handlers_friend::pendsv_switch(prev, next);
 	}
 
 	void SysTick_Handler() {
 		aikartos::kernel::handlers_friend::systick_handler();
 	}
 
+#if defined(KERNEL_USE_STACK_GUARD)
+	void MemManage_Handler() {
+		// Most likely the running task went through its stack guard
+		PANIC("MemManage fault: stack overflow");
+	}
+#endif
+
+#if defined(PLATFORM_USE_FPU)
+	void usage_fault_handler_impl(std::uint32_t *stack_frame, std::uint32_t exc_return) {
+		aikartos::kernel::handlers_friend::usage_fault_handler(stack_frame, exc_return);
+	}
+
+	__attribute__((naked)) void UsageFault_Handler() {
+		asm volatile ("TST     LR, #4");		// LR & 4
+		asm volatile ("ITE     NE");
+		asm volatile ("MRSNE   R0, PSP");	// task stack frame
+		asm volatile ("MRSEQ   R0, MSP");	// handler stack frame
+		asm volatile ("MOV     R1, LR");		// EXC_RETURN
+
+		// Tail call: LR still holds EXC_RETURN, so returning from the C part returns from the exception
+		asm volatile ("LDR     R2, =usage_fault_handler_impl");
+		asm volatile ("BX      R2");
+	}
+#endif
+
 #if defined(PLATFORM_USE_FPU)
 /*
  * Pseudo-code for PendSV_Handler (implemented in assembly):
  *
+ * The FPU is configured for automatic and lazy state preservation (FPCCR.ASPEN, FPCCR.LSPEN).
+ * A task has live FP state only if the hardware stacked an extended frame for it,
+ * which is reported by EXC_RETURN[4] == 0. Only in that case s16–s31 are saved and restored.
+ * VSTMDB also triggers the lazy preservation of s0–s15 and FPSCR into the reserved frame space.
+ *
  *{
- *	disable_irq();
+ *	BASEPRI = g_kernel_basepri; // interrupts above the kernel ceiling keep running
+ *
+ *	// Make the decision first. R0–R3, R12 are already stacked by hardware, R4–R11 are callee-saved.
+ *	next = pendsv_handler_impl();
+ *
+ *	if (next == g_current_tcb_ptr) {
+ *		// Same task: nothing to save or restore
+ *		BASEPRI = 0;
+ *		return EXC_RETURN;
+ *	}
  *
  *	// Save current task context
- *	if (g_current_tcb_ptr->flags & tasks::task_flags::use_fpu) {
+ *	if ((EXC_RETURN & (1 << 4)) == 0) {
  *		store(PSP, {s16–s31});
- *		// remember: we store the registers for this task and will need to restore them
+ *		// remember: the frame is extended and s16–s31 have to be restored
  *		g_current_tcb_ptr->flags |= tasks::task_flags::fpu_saved;
+ *	} else {
+ *		g_current_tcb_ptr->flags &= ~tasks::task_flags::fpu_saved;
  *	}
  *	store(PSP, {R4–R11});
  *	g_current_tcb_ptr->stack = PSP;
  *
- *	// Perform context switch (updates g_current_tcb_ptr)
- *	pendsv_handler_impl();
+ *	prev = g_current_tcb_ptr;
+ *	g_current_tcb_ptr = next;
  *
- *	// Now g_current_tcb_ptr points to the next task
+ *	// Accounting and CPACR for the new task (kernel::set_fpu_auto_enable)
+ *	pendsv_switch_impl(prev, next);
  *
  *	// Restore context of the new task
  *	restore(g_current_tcb_ptr->stack, {R4–R11});
  *
- *	if (g_current_tcb_ptr->flags & tasks::task_flags::use_fpu) {
- *		result = 0xFFFFFFED; // Return with FPU frame
- *	} else {
- *		result = 0xFFFFFFFD; // Return without FPU frame
- *	}
- *
- *	// Restore FPU context if previously saved
  *	if (g_current_tcb_ptr->flags & tasks::task_flags::fpu_saved) {
  *		restore(g_current_tcb_ptr->stack, {s16–s31});
+ *		EXC_RETURN &= ~(1 << 4); // Return with FPU frame
+ *	} else {
+ *		EXC_RETURN |= (1 << 4); // Return without FPU frame
  *	}
  *
  *	PSP = g_current_tcb_ptr->stack;
  *
- *	enable_irq();
+ *	BASEPRI = 0;
  *
- *	return result; // Written to LR
+ *	return EXC_RETURN; // Written to LR
  *
  *}
  *
  **/
 	extern "C" __attribute__((naked)) void PendSV_Handler(void) {
-		__asm volatile ("CPSID   I");
+		__asm volatile ("LDR     R0, =g_kernel_basepri");
+		__asm volatile ("LDR     R0, [R0]");
+		__asm volatile ("MSR     BASEPRI, R0");
+		PENDSV_PROFILE_STAMP(g_pendsv_enter_cycles);
+
+		// Ask for the next task first: R0 = pendsv_handler_impl()
+		asm volatile ("PUSH    {R3, LR}"); // R3 keeps the stack 8-byte aligned
+		asm volatile ("BL      pendsv_handler_impl");
+		asm volatile ("POP     {R3, LR}");
 
-		// Save current task context: read PSP
-		asm volatile ("MRS     R0, PSP");
 		asm volatile ("LDR     R1, =g_current_tcb_ptr");
 		asm volatile ("LDR     R2, [R1]"); 	   // R2 = g_current_tcb_ptr
-		asm volatile ("LDR     R3, [R2, #4]"); // R3 = g_current_tcb_ptr->flags
+		asm volatile ("CMP     R0, R2");
+		asm volatile ("BNE     switch_task");
+
+		// Same task: the context is still in the registers
+		PENDSV_PROFILE_STAMP(g_pendsv_exit_cycles);
+		asm volatile ("MOV     R0, #0");
+		asm volatile ("MSR     BASEPRI, R0");
+		asm volatile ("BX      LR");
 
-		asm volatile ("TST     R3, #(1 << 0)"); // if(flags & tasks::task_flags::use_fpu)
-		asm volatile ("BEQ     no_fpu_use");
+	asm volatile ("switch_task:");
+		asm volatile ("STR     R0, [R1]");     // g_current_tcb_ptr = next
+		asm volatile ("MOV     R12, R0");      // R12 = next
+
+		// Save current task context: read PSP
+		asm volatile ("MRS     R0, PSP");
+		asm volatile ("LDR     R3, [R2, #4]"); // R3 = current->flags
+
+		asm volatile ("TST     LR, #(1 << 4)"); // if(EXC_RETURN[4] == 0) the task has an extended frame
+		asm volatile ("BNE     no_fpu_frame");
 
 		asm volatile ("VSTMDB  R0!, { s16 - s31 }");
 
 		asm volatile ("ORR     R3, R3, #(1 << 1)"); // flags |= tasks::task_flags::fpu_saved
-		asm volatile ("STR     R3, [R2, #4]");
-		asm volatile ("B       no_fpu_use_final");
+		asm volatile ("B       no_fpu_frame_final");
 
-		asm volatile ("no_fpu_use:");
+		asm volatile ("no_fpu_frame:");
 		asm volatile ("BIC     R3, R3, #(1 << 1)"); // flags &= ~tasks::task_flags::fpu_saved
-		asm volatile ("STR     R3, [R2, #4]");
 
-	asm volatile ("no_fpu_use_final:");
+	asm volatile ("no_fpu_frame_final:");
+		asm volatile ("STR     R3, [R2, #4]");
 
 		// Push callee-saved registers R4–R11 onto current task's stack
 		asm volatile ("STMDB   R0!, {R4-R11}");
@@ -174,58 +423,41 @@ extern "C" {
 		// Save updated PSP into current TCB
 		asm volatile ("STR     R0, [R2]");
 
-		// Call C function to switch to next task
-		asm volatile ("PUSH    {LR}");
-		asm volatile ("BL      pendsv_handler_impl");
-		asm volatile ("POP     {LR}");
-
 		// New task...
-		// Load new current_tcb_ptr after switch
-		asm volatile ("LDR     R1, =g_current_tcb_ptr");
-		asm volatile ("LDR     R2, [R1]"); // R2 = g_current_tcb_ptr
+		asm volatile ("MOV     R0, R2");  // prev
+		asm volatile ("MOV     R1, R12"); // next
+		asm volatile ("PUSH    {R12, LR}");
+		asm volatile ("BL      pendsv_switch_impl");
+		asm volatile ("POP     {R12, LR}");
 
 		// Load new task's saved stack pointer
-		asm volatile ("LDR     R0, [R2, #0]"); // R0 = g_current_tcb_ptr->stack
+		asm volatile ("LDR     R0, [R12, #0]"); // R0 = next->stack
 
 		// Restore callee-saved registers for new task
 		asm volatile ("LDMIA   R0!, {R4-R11}");
 
-		asm volatile ("LDR     R3, [R2, #4]");  // R3 = g_current_tcb_ptr->flags
-
-		/******/
-		asm volatile ("TST     R3, #(1 << 0)"); //if (flags & tasks::task_flags::use_fpu)
-		asm volatile ("BEQ     not_using_fpu");
-
-		//; FPCA = 1
-		//	    asm volatile ("MOVW    LR, #0xFFED");
-		//	    asm volatile ("MOVT    LR, #0xFFFF");
-		asm volatile ("LDR     LR, =0xFFFFFFED"); //EXC_RETURN with FPU
-		asm volatile ("B       done_fpca");
-
-	asm volatile ("not_using_fpu:");
-
-		// FPCA = 0
-		//	    asm volatile ("MOVW    LR, #0xFFFD");
-		//	    asm volatile ("MOVT    LR, #0xFFFF");
-		asm volatile ("LDR     LR, =0xFFFFFFFD"); //EXC_RETURN with NO FPU
+		asm volatile ("LDR     R3, [R12, #4]");  // R3 = next->flags
 
-	asm volatile ("done_fpca :");
-		/******/
-
-		asm volatile ("TST     R3, #(1 << 1)");     // if (flags & tasks::task_flags::fpu_saved)
+		asm volatile ("TST     R3, #(1 << 1)");  // if (flags & tasks::task_flags::fpu_saved)
 		asm volatile ("BEQ     no_fpu_saved");
 
-		// flags & TCB_FLAG_USE_FPU != 0
 		asm volatile ("VLDMIA  R0!, {s16-s31}");
+		asm volatile ("BIC     LR, LR, #(1 << 4)"); // EXC_RETURN with FPU frame
+		asm volatile ("B       done_fpca");
 
-		// flags & TCB_FLAG_USE_FPU == 0
 	asm volatile ("no_fpu_saved:");
+		asm volatile ("ORR     LR, LR, #(1 << 4)"); // EXC_RETURN with NO FPU frame
+
+	asm volatile ("done_fpca:");
 
 		// Set PSP to point to new task's stack
 		asm volatile ("MSR     PSP, R0");
 
-		// Re-enable interrupts
-		asm volatile ("CPSIE   I");
+		PENDSV_PROFILE_STAMP(g_pendsv_exit_cycles);
+
+		// Unmask the kernel interrupts
+		asm volatile ("MOV     R0, #0");
+		asm volatile ("MSR     BASEPRI, R0");
 
 		// Return from interrupt - remaining registers restored automatically (R0–R3, R12, LR, PC, xPSR)
 		asm volatile ("BX      LR");
@@ -233,7 +465,33 @@ extern "C" {
 
 #else
 	__attribute__((naked)) void PendSV_Handler() {
-		asm volatile ("CPSID   I");
+		asm volatile ("LDR     R0, =g_kernel_basepri");
+		asm volatile ("LDR     R0, [R0]");
+		asm volatile ("MSR     BASEPRI, R0");
+		PENDSV_PROFILE_STAMP(g_pendsv_enter_cycles);
+
+		// Ask for the next task first: R0 = pendsv_handler_impl()
+		// R0–R3, R12 are stacked by hardware, R4–R11 are preserved by the callee
+		asm volatile ("PUSH    {R3, LR}"); // R3 keeps the stack 8-byte aligned
+		asm volatile ("BL      pendsv_handler_impl");
+		asm volatile ("POP     {R3, LR}");
+
+		// Load current TCB (current_tcb_ptr)
+		asm volatile ("LDR     R1, =g_current_tcb_ptr");
+		asm volatile ("LDR     R2, [R1]");
+
+		// Same task: nothing to save or restore
+		asm volatile ("CMP     R0, R2");
+		asm volatile ("BNE     switch_task");
+		PENDSV_PROFILE_STAMP(g_pendsv_exit_cycles);
+		asm volatile ("MOV     R0, #0");
+		asm volatile ("MSR     BASEPRI, R0");
+		asm volatile ("BX      LR");
+
+	asm volatile ("switch_task:");
+		// current_tcb_ptr = next
+		asm volatile ("STR     R0, [R1]");
+		asm volatile ("MOV     R12, R0");
 
 		// Save current task context: read PSP
 		asm volatile ("MRS     R0, PSP");
@@ -241,26 +499,18 @@ extern "C" {
 		// Push callee-saved registers R4–R11 onto current task's stack
 		asm volatile ("STMDB   R0!, {R4-R11}");
 
-		// Load address of current_tcb_ptr (global pointer to current task)
-		asm volatile ("LDR     R1, =g_current_tcb_ptr");
-
-		// Load current TCB (current_tcb_ptr)
-		asm volatile ("LDR     R2, [R1]");
-
 		// Save updated PSP into current TCB
 		asm volatile ("STR     R0, [R2]");
 
-		// Call C function to switch to next task: current_tcb_ptr = scheduler.get_next()
-		asm volatile ("PUSH    {LR}");
-		asm volatile ("BL      pendsv_handler_impl");
-		asm volatile ("POP     {LR}");
-
-		// Load new current_tcb_ptr after switch
-		asm volatile ("LDR     R1, =g_current_tcb_ptr");
-		asm volatile ("LDR     R2, [R1]");
+		// pendsv_switch_impl(prev, next)
+		asm volatile ("MOV     R0, R2");
+		asm volatile ("MOV     R1, R12");
+		asm volatile ("PUSH    {R12, LR}");
+		asm volatile ("BL      pendsv_switch_impl");
+		asm volatile ("POP     {R12, LR}");
 
 		// Load new task's saved stack pointer
-		asm volatile ("LDR     R0, [R2, #0]");
+		asm volatile ("LDR     R0, [R12, #0]");
 
 		// Restore callee-saved registers for new task
 		asm volatile ("LDMIA   R0!, {R4-R11}");
@@ -268,8 +518,11 @@ extern "C" {
 		// Set PSP to point to new task's stack
 		asm volatile ("MSR     PSP, R0");
 
-		// Re-enable interrupts
-		asm volatile ("CPSIE   I");
+		PENDSV_PROFILE_STAMP(g_pendsv_exit_cycles);
+
+		// Unmask the kernel interrupts
+		asm volatile ("MOV     R0, #0");
+		asm volatile ("MSR     BASEPRI, R0");
 
 		// Return from interrupt - remaining registers restored automatically (R0–R3, R12, LR, PC, xPSR)
 		asm volatile ("BX      LR");
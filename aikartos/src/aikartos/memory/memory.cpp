@@ -11,7 +11,7 @@
 
 #include "aikartos/device/device.hpp"
 #include "aikartos/memory/core.hpp"
-#include "aikartos/sync/irq_critical_section.hpp"
+#include "aikartos/sync/kernel_critical_section.hpp"
 
 extern "C" {
 	extern uint8_t _end;
@@ -25,13 +25,13 @@ namespace aikartos::memory {
 
 		inline static auto alloc(std::size_t size) {
 			DEBUG_ASSERT(core::instance_ != nullptr, "Allocator not initialized");
-			aikartos::sync::irq_critical_section irq_disable;
+			aikartos::sync::kernel_critical_section irq_disable;
 			return core::instance_->alloc(size);
 		}
 
 		inline static auto calloc(std::size_t size) {
 			DEBUG_ASSERT(core::instance_ != nullptr, "Allocator not initialized");
-			aikartos::sync::irq_critical_section irq_disable;
+			aikartos::sync::kernel_critical_section irq_disable;
 			auto *ptr = core::instance_->alloc(size);
 			if(ptr) {
 				std::memset(ptr, 0, size);
@@ -41,13 +41,13 @@ namespace aikartos::memory {
 
 		inline static auto realloc(void *ptr, std::size_t size) {
 			DEBUG_ASSERT(core::instance_ != nullptr, "Allocator not initialized");
-			aikartos::sync::irq_critical_section irq_disable;
+			aikartos::sync::kernel_critical_section irq_disable;
 			return core::instance_->realloc(ptr, size);
 		}
 
 		inline static auto free(void *ptr) {
 			DEBUG_ASSERT(core::instance_ != nullptr, "Allocator not initialized");
-			aikartos::sync::irq_critical_section irq_disable;
+			aikartos::sync::kernel_critical_section irq_disable;
 			return core::instance_->free(ptr);
 		}
 	};
@@ -0,0 +1,62 @@
+/*
+ * bitmap_priority.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#include "aikartos/kernel/kernel.hpp"
+#include "aikartos/kernel/panic.hpp"
+#include "aikartos/sch/scheduler_bitmap_priority.hpp"
+#include "aikartos/this_task/this_task.hpp"
+
+#include "tests.hpp"
+
+#ifdef ENABLE_TEST_bitmap_priority
+
+using namespace aikartos;
+
+namespace {
+
+	// count[0] grows by 100 a second whatever runs below it,
+	// count[1] and count[2] stay close to each other, count[3] stays 0
+	void sampler(void *) {
+		while(1) {
+			count[0]++;
+			this_task::sleep(10);
+		}
+	}
+
+	void worker(void *param) {
+		auto *counter = static_cast<std::uint32_t *>(param);
+		while(1) {
+			(*counter)++;
+		}
+	}
+
+	void starved(void *) {
+		while(1) {
+			count[3]++;
+		}
+	}
+}
+
+namespace tests {
+
+	int test::run() {
+		using config = kernel::config;
+		namespace sch_ns = sch::bitmap_priority;
+		kernel::init<sch_ns::scheduler, config>();
+		using config_flags = sch_ns::config_flags;
+
+		kernel::add_task(&sampler, tasks::config{}.set<config_flags::priority>(0));
+		kernel::add_task(&worker, tasks::config{}.set<config_flags::priority>(17), &count[1]);
+		kernel::add_task(&worker, tasks::config{}.set<config_flags::priority>(17), &count[2]);
+		kernel::add_task(&starved, tasks::config{}.set<config_flags::priority>(config::priority_levels - 1));
+
+		kernel::launch(10);
+		PANIC("Should not be here");
+	}
+}
+
+#endif
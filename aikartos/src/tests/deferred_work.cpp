@@ -0,0 +1,70 @@
+/*
+ * deferred_work.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#include "aikartos/kernel/deferred_work.hpp"
+#include "aikartos/kernel/kernel.hpp"
+#include "aikartos/kernel/panic.hpp"
+#include "aikartos/sch/scheduler_fixed_priority.hpp"
+
+#include "tests.hpp"
+
+#ifdef ENABLE_TEST_deferred_work
+
+using namespace aikartos;
+
+namespace {
+
+	// The heavy part, runs in the worker task. count[0] items done, count[1] the sum of the payloads
+	void process(void *argument) {
+		count[0]++;
+		count[1] += reinterpret_cast<std::uintptr_t>(argument);
+	}
+
+	// Pends the interrupt by software, as if a peripheral raised it
+	void source(void *) {
+		while(1) {
+			NVIC_SetPendingIRQ(EXTI0_IRQn);
+			kernel::sleep(1);
+		}
+	}
+
+	void busy(void *) {
+		while(1) {
+			count[2]++;
+		}
+	}
+}
+
+// The ISR stays short: post and leave. count[3] is the number of interrupts, count[4] the dropped items
+extern "C" void EXTI0_IRQHandler() {
+	count[3]++;
+	kernel::deferred_work::post(&process, reinterpret_cast<void *>(count[3]));
+	count[4] = kernel::deferred_work::get_dropped();
+}
+
+namespace tests {
+
+	int test::run() {
+		using config = kernel::config;
+		namespace sch_ns = sch::fixed_priority;
+		kernel::init<sch_ns::scheduler, config>();
+		using config_flags = sch_ns::config_flags;
+
+		kernel::deferred_work::launch(tasks::config{}.set<config_flags::priority>(0));
+		kernel::add_task(&source, tasks::config{}.set<config_flags::priority>(1));
+		kernel::add_task(&busy, tasks::config{}.set<config_flags::priority>(2));
+
+		// Under the kernel ceiling: the handler calls into the kernel
+		NVIC_SetPriority(EXTI0_IRQn, constants::kernel_irq_ceiling + 1);
+		NVIC_EnableIRQ(EXTI0_IRQn);
+
+		kernel::launch(10);
+		PANIC("Should not be here");
+	}
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * dynamic_tasks.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#include "aikartos/kernel/kernel.hpp"
+#include "aikartos/kernel/panic.hpp"
+#include "aikartos/sch/scheduler_mlfq.hpp"
+#include "aikartos/this_task/this_task.hpp"
+
+#include "aikartos/memory/memory.hpp"
+#include "aikartos/memory/allocator_tlsf.hpp"
+
+#include "tests.hpp"
+
+#ifdef ENABLE_TEST_dynamic_tasks
+
+using namespace aikartos;
+
+namespace {
+
+	// No fixed task table: the pool and the level queues grow from the heap
+	struct config: kernel::config {
+		constexpr static std::uint32_t maximum_tasks = utils::dynamic_extent;
+	};
+
+	constexpr std::size_t permanent_workers = 10;
+	constexpr std::size_t short_workers = 6;
+
+	// count[0..2] are the permanent workers' shares, all of them keep growing
+	void worker(void *param) {
+		auto *counter = static_cast<std::uint32_t *>(param);
+		while(1) {
+			(*counter)++;
+		}
+	}
+
+	// Does a bit of work and returns: its pool slot goes back to the free list
+	void short_worker(void *) {
+		for(std::uint32_t i = 0; i < 100'000; ++i) {
+			count[3]++;
+		}
+	}
+
+	// count[4] is the number of spawned short workers; the pool stops growing after the first batch,
+	// the new workers take the released slots
+	void spawner(void *) {
+		tasks::config cfg;
+		cfg.set<tasks::config_flags::stack_size>(256);
+		while(1) {
+			for(std::size_t i = 0; i < short_workers; ++i) {
+				kernel::add_task(&short_worker, (i % 2) ? cfg : tasks::config{});
+				count[4]++;
+			}
+			this_task::sleep(100);
+		}
+	}
+}
+
+namespace tests {
+
+	int test::run() {
+		namespace sch_ns = sch::mlfq;
+		kernel::init<sch_ns::scheduler, config>();
+		memory::init<memory::allocator_tlsf<>>();
+
+		for(std::size_t i = 0; i < permanent_workers; ++i) {
+			kernel::add_task(&worker, &count[i % 3]);
+		}
+		kernel::add_task(&spawner);
+
+		kernel::launch(10);
+		PANIC("Should not be here");
+	}
+}
+
+#endif
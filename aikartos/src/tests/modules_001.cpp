@@ -62,7 +62,8 @@ namespace tests {
 		aikartos_api api;
 		api.device.uart_write = aikartos::device::uart::blocking_write;
 		api.this_task.sleep = &kernel::sleep;
-		api.kernel.add_task = &kernel::core::add_task;
+		// the SDK entry has no task handle
+		api.kernel.add_task = [](kernel_task_type task, void *parameter) { kernel::core::add_task(task, parameter); };
 
 		if(is_module) {
 			modules::module test_m(bin_data);
@@ -0,0 +1,62 @@
+/*
+ * periodic.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#include "aikartos/kernel/kernel.hpp"
+#include "aikartos/kernel/panic.hpp"
+#include "aikartos/sch/scheduler_fixed_priority.hpp"
+#include "aikartos/this_task/this_task.hpp"
+
+#include "tests.hpp"
+
+#ifdef ENABLE_TEST_periodic
+
+using namespace aikartos;
+
+namespace {
+
+	// 100 Hz. count[0] is the number of samples, count[1] the worst release jitter in ticks,
+	// count[2] the overruns. After N seconds count[0] has to be N * 100, whatever the loop costs.
+	void sampler(void *) {
+		const auto start = kernel::get_tick_count();
+		while(1) {
+			const auto jitter = kernel::get_tick_count() - (start + count[0] * 10);
+			if(jitter > count[1]) {
+				count[1] = jitter;
+			}
+			count[0]++;
+			count[2] = this_task::get_overruns();
+			this_task::wait_next_period();
+		}
+	}
+
+	void busy(void *) {
+		while(1) {
+			count[3]++;
+		}
+	}
+}
+
+namespace tests {
+
+	int test::run() {
+		using config = kernel::config;
+		namespace sch_ns = sch::fixed_priority;
+		kernel::init<sch_ns::scheduler, config>();
+		using config_flags = sch_ns::config_flags;
+
+		kernel::add_task(&sampler, tasks::config{}
+			.set<config_flags::priority>(0)
+			.set<tasks::config_flags::period>(10));
+		kernel::add_task(&busy, tasks::config{}.set<config_flags::priority>(1));
+		kernel::add_task(&busy, tasks::config{}.set<config_flags::priority>(1));
+
+		kernel::launch(10);
+		PANIC("Should not be here");
+	}
+}
+
+#endif
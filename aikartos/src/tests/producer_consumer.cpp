@@ -40,6 +40,9 @@ namespace {
 
 	queue_type g_queue;
 
+	// The only task that drains the queue and releases the messages: the producers hand the CPU to it directly
+	kernel::core::task_block *g_consumer = nullptr;
+
 	void consumer(void *) {
 		while(1) {
 			if(auto next = g_queue.try_pop()) {
@@ -62,10 +65,10 @@ namespace {
 			auto len = snprintf(buf, 100, "Producer 1, count[1] = %lu\r\n", count[1]++);
 			data.len = static_cast<std::uint32_t>(len);
 			while(data.lock.test_and_set(std::memory_order_acquire)) {
-				kernel::yield();
+				kernel::yield_to(g_consumer);
 			}
 			while(!g_queue.try_push(&data)) {
-				kernel::yield();
+				kernel::yield_to(g_consumer);
 			}
 			kernel::sleep(100);
 		}
@@ -79,10 +82,10 @@ namespace {
 			auto len = snprintf(buf, 100, "Producer 2, count[2] = %lu\r\n", count[2]++);
 			data.len = static_cast<std::uint32_t>(len);
 			while(data.lock.test_and_set(std::memory_order_acquire)) {
-				kernel::yield();
+				kernel::yield_to(g_consumer);
 			}
 			while(!g_queue.try_push(&data)) {
-				kernel::yield();
+				kernel::yield_to(g_consumer);
 			}
 			kernel::sleep(100);
 		}
@@ -96,10 +99,10 @@ namespace {
 			auto len = snprintf(buf, 100, "Producer 3, count[3] = %lu\r\n", count[3]++);
 			data.len = static_cast<std::uint32_t>(len);
 			while(data.lock.test_and_set(std::memory_order_acquire)) {
-				kernel::yield();
+				kernel::yield_to(g_consumer);
 			}
 			while(!g_queue.try_push(&data)) {
-				kernel::yield();
+				kernel::yield_to(g_consumer);
 			}
 			kernel::sleep(100);
 		}
@@ -118,7 +121,7 @@ namespace tests {
 
 		device::uart::init_tx();
 
-		kernel::add_task(&consumer);
+		g_consumer = kernel::add_task(&consumer);
 		kernel::add_task(&producer1);
 		kernel::add_task(&producer2);
 		kernel::add_task(&producer3);
@@ -8,6 +8,7 @@
 #include "aikartos/kernel/config.hpp"
 #include "aikartos/kernel/kernel.hpp"
 #include "aikartos/kernel/panic.hpp"
+#include "aikartos/kernel/static_dispatch.hpp"
 #include "aikartos/sch/scheduler_round_robin.hpp"
 
 #include "tests.hpp"
@@ -16,6 +17,9 @@ using namespace aikartos;
 
 #ifdef ENABLE_TEST_round_robin
 
+// PendSV calls the round robin scheduler directly, no virtual dispatch
+AIKARTOS_KERNEL_STATIC_DISPATCH(sch::round_robin::scheduler, kernel::config)
+
 namespace {
 	void task0(void *)
 	{
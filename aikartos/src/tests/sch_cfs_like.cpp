@@ -41,6 +41,14 @@ namespace {
 			 count[2]++;
 		 }
 	}
+
+	// nice -5: ~3 times the CPU share of task2
+	void task3(void *)
+	{
+		 while(1){
+			 count[3]++;
+		 }
+	}
 }
 
 namespace tests {
@@ -49,10 +57,12 @@ namespace tests {
 		using config = kernel::config;
 		namespace sch_ns = sch::cfs_like;
 		kernel::init<sch_ns::scheduler, config>();
+		using config_flags = sch_ns::config_flags;
 
 		kernel::add_task(&task0);
 		kernel::add_task(&task1);
 		kernel::add_task(&task2);
+		kernel::add_task(&task3, tasks::config{}.set<config_flags::nice>(-5));
 
 		kernel::launch(10);
 		PANIC("Should not be here");
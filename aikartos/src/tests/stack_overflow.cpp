@@ -27,6 +27,8 @@ namespace {
 		return 0;
 	}
 
+	// Without KERNEL_USE_STACK_GUARD it silently corrupts the memory below the stack,
+	// with it the MPU guard stops the task at the bottom of its stack (MemManage_Handler)
 	void task0(void*) {
 		recursive(10);
 	}
@@ -12,17 +12,22 @@
 //#define ENABLE_TEST_round_robin
 //#define ENABLE_TEST_edf
 //#define ENABLE_TEST_fixed_priority
+//#define ENABLE_TEST_bitmap_priority
 //#define ENABLE_TEST_weighted_lottery
 //#define ENABLE_TEST_coop_preemptive
 //#define ENABLE_TEST_lottery
 //#define ENABLE_TEST_priority_aging
 //#define ENABLE_TEST_stack_overflow
+//#define ENABLE_TEST_timers
+//#define ENABLE_TEST_periodic
+//#define ENABLE_TEST_deferred_work
 
 //#define ENABLE_TEST_uart_blocking_write
 //#define ENABLE_TEST_producer_consumer
 
 //#define ENABLE_TEST_sch_cfs_like
 //#define ENABLE_TEST_sch_mlfq
+//#define ENABLE_TEST_dynamic_tasks
 
 //#define ENABLE_TEST_memory_allocation_free_list
 //#define ENABLE_TEST_memory_allocation_bump_list
@@ -0,0 +1,67 @@
+/*
+ * timers.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: newenclave
+ */
+
+#include "aikartos/kernel/kernel.hpp"
+#include "aikartos/kernel/panic.hpp"
+#include "aikartos/kernel/timers.hpp"
+#include "aikartos/sch/scheduler_round_robin.hpp"
+
+#include "tests.hpp"
+
+#ifdef ENABLE_TEST_timers
+
+using namespace aikartos;
+
+namespace {
+
+	// How late the last fast callback ran: the service task waits for task0 to use up its turn, a quanta at most
+	std::uint32_t fast_lateness = 0;
+
+	// count[0] grows by 10 a second, count[1] by 1 until the one-shot stops it.
+	// count[2] is the expiry of the last fast callback: it stays a multiple of 100, the period doesn't drift
+	kernel::timer fast([](kernel::timer &self, void *) {
+		count[0]++;
+		count[2] = self.get_expiry();
+		fast_lateness = kernel::get_tick_count() - self.get_expiry();
+	});
+
+	kernel::timer slow([](kernel::timer &, void *) {
+		count[1]++;
+	});
+
+	kernel::timer stopper([](kernel::timer &, void *) {
+		slow.stop();
+		count[3] = fast.get_overruns();
+	});
+
+	void task0(void *) {
+		while(1) {
+			count[4]++;
+		}
+	}
+}
+
+namespace tests {
+
+	int test::run() {
+		using config = kernel::config;
+		namespace sch_ns = sch::round_robin;
+		kernel::init<sch_ns::scheduler, config>();
+
+		kernel::timer_service::launch();
+		kernel::add_task(&task0);
+
+		fast.start(100, 100);
+		slow.start(1000, 1000);
+		stopper.start(10'000);
+
+		kernel::launch(10);
+		PANIC("Should not be here");
+	}
+}
+
+#endif